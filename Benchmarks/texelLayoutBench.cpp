@@ -0,0 +1,138 @@
+// Benchmark of the CPU-side texel layouts used by the floor casting.
+// It replays the texel fetches of RayCasting::FloorCeilingCasting for several
+// view angles and runs them through a simulated L1 data cache, so the miss
+// rate of each layout can be compared on any machine. The wall-clock time of
+// the same fetch stream on the real hardware is printed next to it.
+//
+// Build and run with: make bench
+
+#include "../texelLayout.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Screen area covered by the floor casting (half of the 1024 x 512 window)
+const unsigned int VIEW_WIDTH = 512;
+const unsigned int VIEW_HEIGHT = 512;
+// Bytes per texel (the floor casting reads RGB)
+const unsigned int CHANNELS = 3;
+
+// Simulated cache: 32 KiB, 8-way set associative, 64-byte lines, LRU
+const unsigned int CACHE_LINE = 64;
+const unsigned int CACHE_WAYS = 8;
+const unsigned int CACHE_SETS = (32 * 1024) / (CACHE_LINE * CACHE_WAYS);
+
+class CacheModel {
+
+    public:
+    unsigned long long Accesses = 0, Misses = 0;
+
+    CacheModel() : tags(CACHE_SETS * CACHE_WAYS, ~0ull), ages(CACHE_SETS * CACHE_WAYS, 0) { }
+
+    void Access(unsigned long long address) {
+        unsigned long long line = address / CACHE_LINE;
+        unsigned int set = line % CACHE_SETS;
+        unsigned long long* setTags = &tags[set * CACHE_WAYS];
+        unsigned long long* setAges = &ages[set * CACHE_WAYS];
+
+        Accesses++;
+        clock++;
+
+        // Hit: refresh the age of the line
+        unsigned int oldest = 0;
+        for(unsigned int way = 0; way < CACHE_WAYS; way++) {
+            if(setTags[way] == line) { setAges[way] = clock; return; }
+            if(setAges[way] < setAges[oldest]) oldest = way;
+        }
+
+        // Miss: replace the least recently used line of the set
+        Misses++;
+        setTags[oldest] = line;
+        setAges[oldest] = clock;
+    }
+
+    private:
+    std::vector<unsigned long long> tags, ages;
+    unsigned long long clock = 0;
+};
+
+// Generates the texel (x, y) sequence the floor casting reads for a player looking at angle degrees
+static std::vector<unsigned int> floorFetches(float angle, unsigned int size)
+{
+    std::vector<unsigned int> fetches;
+    fetches.reserve(VIEW_WIDTH * VIEW_HEIGHT / 2 * 2);
+
+    float radians = angle * 3.14159265f / 180.0f;
+    float dirX = std::cos(radians), dirY = std::sin(radians);
+    // Camera plane perpendicular to the direction, FOV of 66 degrees
+    float planeX = -dirY * 0.66f, planeY = dirX * 0.66f;
+    float posX = 8.37f, posY = 8.61f;
+
+    for(unsigned int y = VIEW_HEIGHT / 2 + 1; y < VIEW_HEIGHT; y++) {
+        float rowDistance = (0.5f * VIEW_HEIGHT) / (y - VIEW_HEIGHT / 2);
+        float stepX = rowDistance * (2.0f * planeX) / VIEW_WIDTH;
+        float stepY = rowDistance * (2.0f * planeY) / VIEW_WIDTH;
+        float floorX = posX + rowDistance * (dirX - planeX);
+        float floorY = posY + rowDistance * (dirY - planeY);
+
+        for(unsigned int x = 0; x < VIEW_WIDTH; x++) {
+            float fx = floorX - std::floor(floorX);
+            float fy = floorY - std::floor(floorY);
+            // Same bitmasks as the floor casting
+            unsigned int texX = static_cast<unsigned int>(size * fx) & (size - 1);
+            unsigned int texY = static_cast<unsigned int>(size * fy) & (size - 1);
+            fetches.push_back(texX | (texY << 16));
+            floorX += stepX;
+            floorY += stepY;
+        }
+    }
+    return fetches;
+}
+
+int main()
+{
+    const TexelLayout layouts[] = { TEXEL_ROW_MAJOR, TEXEL_TILED, TEXEL_MORTON };
+    const char* names[] = { "row-major", "tiled 4x4", "morton" };
+    const unsigned int sizes[] = { 64, 256, 1024 };
+
+    for(unsigned int size : sizes) {
+
+        // Texture contents do not matter, only the addresses do
+        std::vector<unsigned char> texels(size * size * CHANNELS, 1);
+
+        std::printf("\n=== %ux%u RGB texture (%u KiB), simulated 32 KiB / %u-way L1 ===\n",
+                    size, size, size * size * CHANNELS / 1024, CACHE_WAYS);
+        std::printf("%6s", "angle");
+        for(const char* name : names) std::printf(" | %9s miss%% %7s", name, "ns/tex");
+        std::printf("\n");
+
+        for(float angle = 0.0f; angle <= 90.0f; angle += 15.0f) {
+
+            std::vector<unsigned int> fetches = floorFetches(angle, size);
+            std::printf("%6.0f", angle);
+
+            for(TexelLayout layout : layouts) {
+                CacheModel cache;
+                for(unsigned int fetch : fetches) {
+                    unsigned int index = TexelIndex(layout, fetch & 0xFFFF, fetch >> 16, size, size);
+                    cache.Access(static_cast<unsigned long long>(index) * CHANNELS);
+                }
+
+                // Timing of the same stream on the real cache
+                unsigned int checksum = 0;
+                auto start = std::chrono::steady_clock::now();
+                for(int repeat = 0; repeat < 8; repeat++)
+                    for(unsigned int fetch : fetches)
+                        checksum += texels[TexelIndex(layout, fetch & 0xFFFF, fetch >> 16, size, size) * CHANNELS];
+                auto end = std::chrono::steady_clock::now();
+                double ns = std::chrono::duration<double, std::nano>(end - start).count() / (8.0 * fetches.size());
+
+                std::printf(" | %15.2f %7.2f", 100.0 * cache.Misses / cache.Accesses, ns + (checksum == 0xFFFFFFFF));
+            }
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
@@ -3,7 +3,7 @@ in vec2 TexCoords;
 out vec4 color;
 
 uniform sampler2D image;
-uniform vec3 spriteColor;
+in vec3 spriteColor; // Tint of the quad (per vertex, so quads with different tints share a draw)
 
 void main()
 {    
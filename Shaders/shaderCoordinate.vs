@@ -1,13 +1,24 @@
 #version 330 core
-layout (location = 0) in vec4 vertex; 
+// Quad corners computed by the SpriteBatch, already in screen pixels
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 texCoords;
+layout (location = 2) in vec3 color;
 
 out vec2 TexCoords;
+out vec3 spriteColor; // Tint of the quad
 
-uniform mat4 model;
-uniform mat4 projection;
+// Shared per-frame values (FrameUniforms)
+layout (std140) uniform Frame {
+    mat4 projection;
+    mat4 textProjection;
+    vec2 screenSize;
+    float viewWidth;
+    float viewStart;
+};
 
 void main()
 {
-    gl_Position = projection * model * vec4(vertex.xy, 0.0, 1.0);
-    TexCoords = vertex.zw;
-}
\ No newline at end of file
+    gl_Position = projection * vec4(position, 0.0, 1.0);
+    TexCoords = texCoords;
+    spriteColor = color;
+}
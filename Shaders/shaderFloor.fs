@@ -9,7 +9,7 @@ uniform vec2 floor;
 uniform vec2 floorStep;
 uniform int screenWidth;
 
-uniform vec3 spriteColor;
+in vec3 spriteColor; // Tint of the quad (per vertex, so quads with different tints share a draw)
 
 
 
@@ -0,0 +1,14 @@
+#version 330 core
+in vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D image;   // Palette indices of the software framebuffer (one byte per pixel)
+uniform sampler2D palette; // The 256 colors of the palette in one row
+in vec3 spriteColor;
+
+void main()
+{
+    // The index is stored normalized, the palette texel of index i is at (i + 0.5) / 256
+    float index = texture(image, TexCoords).r;
+    color = vec4(spriteColor, 1.0) * texture(palette, vec2((index * 255.0 + 0.5) / 256.0, 0.5));
+}
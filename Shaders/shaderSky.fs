@@ -0,0 +1,16 @@
+#version 330 core
+in vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D image;
+in vec3 spriteColor; // Tint of the quad (per vertex, so quads with different tints share a draw)
+uniform float skyOffset; // Horizontal texture position given by the player direction
+uniform float skySpan; // Portion of the texture seen through the FOV (negative flips it)
+
+
+void main()
+{    
+    // GL_REPEAT wraps the sky around the player
+    vec2 skyCoords = vec2(skyOffset + (TexCoords.x - 0.5) * skySpan, TexCoords.y);
+    color = vec4(spriteColor, 1.0) * texture(image, skyCoords);
+}
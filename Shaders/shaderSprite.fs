@@ -1,37 +1,56 @@
 #version 330 core
 in vec2 TexCoords;
+flat in float spriteDepth; // The TransformY that checks how deep is the srpite on the POV
+flat in float layer; // Layer of the sprite texture
+flat in float depthRange; // 0 for a sprite, the alpha of an impostor keeps the depth of each of its sprites
+flat in vec3 spriteColor;
 out vec4 color;
 
-uniform sampler2D image;
-uniform float ZBuffer[512]; // By defauly our screen size is 1024, so half of it
-uniform float screenWidth; // Total Screen Width
-uniform float spriteDepth; // The TransformY that checks how deep is the srpite on the POV
-
-uniform vec3 spriteColor;
+uniform sampler2DArray image;
+uniform sampler2D depthMap; // The ZBuffer: one texel per ray column
+// Shared per-frame values (FrameUniforms)
+layout (std140) uniform Frame {
+    mat4 projection;
+    mat4 textProjection;
+    vec2 screenSize;
+    float viewWidth;
+    float viewStart;
+};
 
 
 
 void main()
 {       
 
-    // Since we are drawing half of screen, the first position of the screenX is >= screenWidth/2
-    // Get the pixels screen X coordinate
-    int screenX = int(gl_FragCoord.x) - int(screenWidth/2);
+    // The depth map covers the 3D view with its own number of columns
+    // Get the ray column under this pixel
+    int columns = textureSize(depthMap, 0).x;
+    int screenX = int((gl_FragCoord.x - viewStart) / viewWidth * float(columns));
 
     // Read the wall distance for this pixel
-    float wallDepth = ZBuffer[screenX];
+    float wallDepth = texelFetch(depthMap, ivec2(screenX, 0), 0).r;
 
-    // If the sprite is behind the wall, skip drawing
-    if(spriteDepth > wallDepth)
+    // The nearest sprite of an impostor can still be in front of the wall
+    if(spriteDepth - depthRange > wallDepth)
         discard;
 
     
-    vec4 texColor = vec4(spriteColor, 1.0) * texture(image, TexCoords);
+    vec4 texColor = vec4(spriteColor, 1.0) * texture(image, vec3(TexCoords, layer));
 
     // Discart if the pixel is black (or almost black)
     if(texColor.r <= 0.001 && texColor.g <= 0.001 && texColor.b <= 0.001)
         discard;
 
+    // If the sprite is behind the wall, skip drawing
+    // Each texel of an impostor has the depth of its own sprite: alpha 0 -> -depthRange, 1 -> +depthRange
+    if(depthRange > 0.0) {
+        if(spriteDepth + (texColor.a * 2.0 - 1.0) * depthRange > wallDepth)
+            discard;
+        texColor.a = 1.0;
+    }
+    else if(spriteDepth > wallDepth)
+        discard;
+
     color = texColor;
     
 
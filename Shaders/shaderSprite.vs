@@ -1,15 +1,32 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; 
+// Per-instance attributes
+layout (location = 1) in vec4 rect; // Screen position (xy) and size (zw)
+layout (location = 2) in vec4 uvRect; // Texture rectangle covered by the quad (tight bounds + screen clipping)
+layout (location = 3) in vec3 depthLayer; // TransformY of the sprite, its texture layer and the depth range of an impostor
+layout (location = 4) in vec3 tint;
 
 out vec2 TexCoords;
+flat out float spriteDepth; // The TransformY that checks how deep is the srpite on the POV
+flat out float layer;
+flat out float depthRange;
+flat out vec3 spriteColor;
 
-uniform mat4 model;
-uniform mat4 projection;
-uniform float u_start;
-uniform float u_end;
+// Shared per-frame values (FrameUniforms)
+layout (std140) uniform Frame {
+    mat4 projection;
+    mat4 textProjection;
+    vec2 screenSize;
+    float viewWidth;
+    float viewStart;
+};
 
 void main()
 {
-    gl_Position = projection * model * vec4(vertex.xy, 0.0, 1.0);
-    TexCoords = vec2(u_start + (u_end - u_start) * vertex.z, vertex.w);
-}
\ No newline at end of file
+    gl_Position = projection * vec4(rect.xy + vertex.xy * rect.zw, 0.0, 1.0);
+    TexCoords = mix(uvRect.xy, uvRect.zw, vertex.zw);
+    spriteDepth = depthLayer.x;
+    layer = depthLayer.y;
+    depthRange = depthLayer.z;
+    spriteColor = tint;
+}
@@ -3,10 +3,20 @@ layout (location = 0) in vec4 vertex;
 
 out vec2 TexCoords;
 
-uniform mat4 projection;
+// Shared per-frame values (FrameUniforms)
+layout (std140) uniform Frame {
+    mat4 projection;
+    mat4 textProjection;
+    vec2 screenSize;
+    float viewWidth;
+    float viewStart;
+};
+
+// The string meshes are built at the origin with scale 1: screen position (xy) and scale (z)
+uniform vec3 textTransform;
 
 void main()
 {
-    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
+    gl_Position = textProjection * vec4(textTransform.xy + vertex.xy * textTransform.z, 0.0, 1.0);
     TexCoords = vertex.zw;
-}
\ No newline at end of file
+}
@@ -0,0 +1,28 @@
+#version 330 core
+in vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D image;  // The 3D view at its internal resolution (bilinear filtering)
+uniform vec2 sourceSize;  // Pixels drawn in the corner of the texture
+uniform float prescale;   // Window pixels per view pixel, rounded down (0 = nearest)
+in vec3 spriteColor;
+
+void main()
+{
+    vec2 size = vec2(textureSize(image, 0));
+    vec2 texel = TexCoords * size;
+    vec2 center = floor(texel) + 0.5;
+    vec2 offset = vec2(0.0);
+
+    // Sharp bilinear: the inside of each view pixel is flat, only the last 0.5 / prescale
+    // of it is blended with the neighbour, so the edges stay one window pixel wide
+    if(prescale > 0.0) {
+        vec2 edge = vec2(0.5 - 0.5 / prescale);
+        vec2 fromCenter = texel - center;
+        offset = (fromCenter - clamp(fromCenter, -edge, edge)) * prescale;
+    }
+
+    // The texels past the drawn corner are left over from larger scales
+    vec2 coords = clamp(center + offset, vec2(0.5), sourceSize - 0.5);
+    color = vec4(spriteColor * texture(image, coords / size).rgb, 1.0);
+}
@@ -0,0 +1,60 @@
+#include "cameraPath.h"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+
+bool CameraPath::Load(const std::string &path)
+{
+    std::ifstream file(path);
+    if(!file) {
+        std::cerr << "ERROR::CAMERA_PATH: could not open -> " << path << std::endl;
+        return false;
+    }
+
+    this->Keys.clear();
+    std::string line;
+    unsigned int number = 0;
+    while(std::getline(file, line)) {
+        number++;
+        size_t start = line.find_first_not_of(" \t\r");
+        if(start == std::string::npos || line[start] == '#') continue;
+
+        std::istringstream values(line);
+        CameraKey key;
+        if(!(values >> key.Position.x >> key.Position.y >> key.Angle)) {
+            std::cerr << "ERROR::CAMERA_PATH: expected \"x y angle\" on line " << number << " of " << path << std::endl;
+            return false;
+        }
+        this->Keys.push_back(key);
+    }
+
+    if(this->Keys.empty()) {
+        std::cerr << "ERROR::CAMERA_PATH: no keys in " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+CameraKey CameraPath::Sample(float t) const
+{
+    if(this->Keys.size() == 1 || t <= 0.0f) return this->Keys.front();
+    if(t >= 1.0f) return this->Keys.back();
+
+    // Segment holding t and the position inside it
+    float segments = static_cast<float>(this->Keys.size() - 1);
+    unsigned int segment = static_cast<unsigned int>(t * segments);
+    float local = t * segments - segment;
+    const CameraKey &from = this->Keys[segment];
+    const CameraKey &to = this->Keys[segment + 1];
+
+    // The angle turns the short way round (350 -> 10 goes through 0)
+    float turn = std::fmod(to.Angle - from.Angle + 540.0f, 360.0f) - 180.0f;
+
+    CameraKey key;
+    key.Position = glm::mix(from.Position, to.Position, local);
+    key.Angle = from.Angle + turn * local;
+    return key;
+}
@@ -0,0 +1,38 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include "glm/glm.hpp"
+
+#include <string>
+#include <vector>
+
+// One point of a camera path: where the player stands (in map cells) and
+// where it looks (in degrees, 0 looks along +x and 90 along +y)
+struct CameraKey
+{
+    glm::vec2 Position;
+    float Angle;
+};
+
+// Camera path read from a text file with one key per line:
+//
+//   # x y angle
+//   3.5 4.5 180
+//   6.5 4.5 90
+//
+// The frames are spread evenly over the path, the camera moving in a
+// straight line (and turning the short way) between consecutive keys.
+class CameraPath
+{
+public:
+    std::vector<CameraKey> Keys;
+
+    CameraPath() { }
+
+    // Reads the keys of a path file (blank lines and lines starting with '#' are skipped)
+    bool Load(const std::string &path);
+    // Camera at t, from 0 (first key) to 1 (last key)
+    CameraKey Sample(float t) const;
+};
+
+#endif
@@ -1,8 +1,14 @@
 #include "character.h"
 
 
+// Default Constructor
+Character::Character()
+    : UV(0.0f), Size(0), Bearing(0), Advance(0) {
+
+}
+
 // Constructor with arguments
-Character::Character(unsigned int textureId, glm::ivec2 size, glm::ivec2 bearing, unsigned int advance) 
-    : TextureID(textureId), Size(size), Bearing(bearing), Advance(advance) {
+Character::Character(glm::vec4 uv, glm::ivec2 size, glm::ivec2 bearing, unsigned int advance) 
+    : UV(uv), Size(size), Bearing(bearing), Advance(advance) {
 
-}
\ No newline at end of file
+}
@@ -10,14 +10,16 @@
 class Character {
 
     public:
-        unsigned int TextureID; // ID handle of the glyph texture
+        glm::vec4    UV;        // Rectangle of the glyph in the font atlas (u0, v0, u1, v1)
         glm::ivec2   Size;      // Size of glyph
         glm::ivec2   Bearing;   // Offset from baseline to left/top of glyph
         unsigned int Advance;   // Horizontal offset to advance to next glyph
 
 
+    // Constructor (empty glyph)
+    Character();
     // Constructor
-    Character(unsigned int textureID, glm::ivec2 size, glm::ivec2 bearing, unsigned int advance);
+    Character(glm::vec4 uv, glm::ivec2 size, glm::ivec2 bearing, unsigned int advance);
 };
 
 #endif
@@ -0,0 +1,70 @@
+#include "collisionGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+void CollisionGrid::Build(const std::vector<GameObject>& elements, unsigned int mapWidth, unsigned int mapHeight, float tileSize)
+{
+    this->Width = mapWidth;
+    this->Height = mapHeight;
+
+    unsigned int cells = mapWidth * mapHeight;
+    this->cellStart.assign(cells + 1, 0);
+    this->centers.clear();
+
+    // Cell of each solid sprite. Elements placed outside the map go to the closest border cell
+    std::vector<unsigned int> spriteCell;
+    std::vector<glm::vec2> spriteCenter;
+    for(const GameObject& element : elements) {
+        if(!element.IsSolid) continue;
+
+        glm::vec2 center = element.Position / tileSize;
+        int x = std::clamp(static_cast<int>(center.x), 0, static_cast<int>(mapWidth) - 1);
+        int y = std::clamp(static_cast<int>(center.y), 0, static_cast<int>(mapHeight) - 1);
+
+        spriteCell.push_back(y * mapWidth + x);
+        spriteCenter.push_back(center);
+        this->cellStart[spriteCell.back() + 1]++;
+    }
+
+    // Counts -> starting slots
+    for(unsigned int c = 0; c < cells; c++)
+        this->cellStart[c + 1] += this->cellStart[c];
+
+    // Fill the buckets with the centers
+    this->centers.resize(spriteCenter.size());
+    std::vector<unsigned int> next(this->cellStart.begin(), this->cellStart.end() - 1);
+    for(unsigned int i = 0; i < spriteCenter.size(); i++)
+        this->centers[next[spriteCell[i]]++] = spriteCenter[i];
+}
+
+bool CollisionGrid::Blocked(glm::vec2 position, glm::vec2 step, float radius) const
+{
+    if(this->centers.empty()) return false;
+
+    glm::vec2 next = position + step;
+    float reach = radius + SPRITE_HITBOX_RADIUS;
+
+    // A sprite is bucketed by its center, so the cells within reach cover every sprite that can touch the circle
+    int x0 = std::max(static_cast<int>(std::floor(next.x - reach)), 0);
+    int y0 = std::max(static_cast<int>(std::floor(next.y - reach)), 0);
+    int x1 = std::min(static_cast<int>(std::floor(next.x + reach)), static_cast<int>(this->Width) - 1);
+    int y1 = std::min(static_cast<int>(std::floor(next.y + reach)), static_cast<int>(this->Height) - 1);
+
+    for(int y = y0; y <= y1; y++) {
+        // The cells of a row are contiguous, so the whole row is one range of centers
+        const glm::vec2* center = this->centers.data() + this->cellStart[y * this->Width + x0];
+        const glm::vec2* end = this->centers.data() + this->cellStart[y * this->Width + x1 + 1];
+
+        for(; center != end; center++) {
+            glm::vec2 offset = next - *center;
+            if(glm::dot(offset, offset) >= reach * reach) continue;
+
+            // Overlapping: only block the step if it goes towards the sprite
+            if(glm::dot(step, *center - position) > 0.0f) return true;
+        }
+    }
+
+    return false;
+}
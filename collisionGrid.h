@@ -0,0 +1,41 @@
+#ifndef COLLISION_GRID_H
+#define COLLISION_GRID_H
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "gameObject.h"
+
+// Radius of the circle hitbox of a solid sprite (in map cells)
+const float SPRITE_HITBOX_RADIUS = 0.3f;
+
+// Solid sprites bucketed by map cell for the player collision.
+// Same packing as the SpriteGrid, but only the solid sprites are stored and
+// their centers are copied next to each other in bucket order, so a query
+// reads the sprites of the 3x3 cells around the player from contiguous memory.
+// Positions are in map cells (1.0 = one wall).
+class CollisionGrid
+{
+public:
+    // Map size in cells
+    unsigned int Width = 0, Height = 0;
+
+    CollisionGrid() { }
+
+    // Buckets the solid elements in the cell that holds their center
+    void Build(const std::vector<GameObject>& elements, unsigned int mapWidth, unsigned int mapHeight, float tileSize);
+
+    // True if a circle moved by step lands on a solid sprite. Moving away from a
+    // sprite the circle already touches is allowed, so the player can never get stuck
+    bool Blocked(glm::vec2 position, glm::vec2 step, float radius) const;
+
+    // Number of solid sprites in the grid
+    unsigned int Count() const { return this->centers.size(); }
+
+private:
+    std::vector<unsigned int> cellStart; // First slot of each cell (Width * Height + 1 entries)
+    std::vector<glm::vec2> centers;      // Centers of the solid sprites grouped by cell
+};
+
+#endif
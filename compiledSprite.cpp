@@ -0,0 +1,58 @@
+#include "compiledSprite.h"
+
+#include <algorithm>
+
+
+void CompiledSprite::Compile(const unsigned char* rgba, unsigned int size)
+{
+    this->Size = size;
+    this->columnStart.assign(size + 1, 0);
+    this->posts.clear();
+
+    unsigned int minX = size, minY = size, maxX = 0, maxY = 0;
+
+    for(unsigned int x = 0; x < size; x++) {
+        this->columnStart[x] = this->posts.size();
+
+        // Walks down the column opening a post on the first opaque texel and closing it on the next black one
+        unsigned int y = 0;
+        while(y < size) {
+            const unsigned char* texel = rgba + (y * size + x) * 4;
+            if((texel[0] | texel[1] | texel[2]) == 0) { y++; continue; }
+
+            unsigned int top = y;
+            while(y < size) {
+                texel = rgba + (y * size + x) * 4;
+                if((texel[0] | texel[1] | texel[2]) == 0) break;
+                y++;
+            }
+
+            SpritePost post;
+            post.Top = static_cast<unsigned short>(top);
+            post.Length = static_cast<unsigned short>(y - top);
+            this->posts.push_back(post);
+
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, top);
+            maxY = std::max(maxY, y - 1);
+        }
+    }
+    this->columnStart[size] = this->posts.size();
+
+    this->Empty = this->posts.empty();
+    if(this->Empty) {
+        this->Bounds = glm::vec4(0.0f);
+        return;
+    }
+
+    // Texel edges -> texture coordinates
+    this->Bounds = glm::vec4(minX, minY, maxX + 1, maxY + 1) / static_cast<float>(size);
+}
+
+glm::vec4 CompiledSprite::PaddedBounds() const
+{
+    float texel = 1.0f / this->Size;
+    return glm::vec4(std::max(this->Bounds.x - texel, 0.0f), std::max(this->Bounds.y - texel, 0.0f),
+                     std::min(this->Bounds.z + texel, 1.0f), std::min(this->Bounds.w + texel, 1.0f));
+}
@@ -0,0 +1,47 @@
+#ifndef COMPILED_SPRITE_H
+#define COMPILED_SPRITE_H
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// Vertical run of opaque texels inside one column of a sprite
+struct SpritePost {
+    unsigned short Top;    // First texel row of the run
+    unsigned short Length; // Number of texels in the run
+};
+
+// Sprite preprocessed at load time, in the spirit of the old column "patch" formats.
+// Black texels are transparent (same rule as the sprite shader), so each column is
+// run-length encoded into its opaque posts, and the opaque texels are wrapped in a
+// tight rectangle. The GPU path uses the rectangle to draw smaller quads and the CPU
+// rasterizer only walks the posts.
+class CompiledSprite
+{
+public:
+    // Side of the source texture (the texel arena size)
+    unsigned int Size = 0;
+    // Tight bounds of the opaque texels in texture coordinates (u0, v0, u1, v1)
+    glm::vec4 Bounds = glm::vec4(0.0f);
+    // True when the texture has no opaque texel at all
+    bool Empty = true;
+
+    CompiledSprite() { }
+
+    // Builds the bounds and posts from a row-major RGBA image of size x size texels
+    void Compile(const unsigned char* rgba, unsigned int size);
+
+    // Bounds grown by one texel on each side (clamped to the texture), so the
+    // linear filtering of the GPU keeps the same soft edges as the full quad
+    glm::vec4 PaddedBounds() const;
+
+    // Posts of the column x, from the top to the bottom
+    const SpritePost* ColumnBegin(unsigned int x) const { return this->posts.data() + this->columnStart[x]; }
+    const SpritePost* ColumnEnd(unsigned int x) const { return this->posts.data() + this->columnStart[x + 1]; }
+
+private:
+    std::vector<unsigned int> columnStart; // First post of each column (Size + 1 entries)
+    std::vector<SpritePost> posts;         // Posts grouped by column
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include "depthHierarchy.h"
+
+#include <algorithm>
+
+
+void DepthHierarchy::Build(const std::vector<float>& zBuffer)
+{
+    // Level 0 + one level per fanout step, until a single entry covers the whole screen
+    unsigned int count = 1;
+    for(unsigned int size = zBuffer.size(); size > 1; size = (size + DEPTH_HIERARCHY_FANOUT - 1) / DEPTH_HIERARCHY_FANOUT)
+        count++;
+    this->levels.resize(count);
+
+    this->levels[0].assign(zBuffer.begin(), zBuffer.end());
+
+    for(unsigned int level = 1; level < count; level++) {
+        const std::vector<float>& below = this->levels[level - 1];
+        std::vector<float>& current = this->levels[level];
+        current.resize((below.size() + DEPTH_HIERARCHY_FANOUT - 1) / DEPTH_HIERARCHY_FANOUT);
+
+        for(unsigned int i = 0; i < current.size(); i++) {
+            unsigned int begin = i * DEPTH_HIERARCHY_FANOUT;
+            unsigned int end = std::min(begin + DEPTH_HIERARCHY_FANOUT, static_cast<unsigned int>(below.size()));
+            current[i] = *std::max_element(below.begin() + begin, below.begin() + end);
+        }
+    }
+}
+
+float DepthHierarchy::MaxDepth(int first, int last) const
+{
+    if(this->levels.empty()) return 0.0f;
+
+    first = std::max(first, 0);
+    last = std::min(last, static_cast<int>(this->levels[0].size()));
+
+    float result = 0.0f;
+
+    // Climbs the levels: the unaligned columns on both ends are read on the current
+    // level and the aligned middle part is left to the coarser one
+    for(unsigned int level = 0; level < this->levels.size() && first < last; level++) {
+        const std::vector<float>& depths = this->levels[level];
+
+        // Last level, or a range too small to have an aligned block: read what is left
+        if(level + 1 == this->levels.size() || last - first < static_cast<int>(DEPTH_HIERARCHY_FANOUT)) {
+            for(int i = first; i < last; i++) result = std::max(result, depths[i]);
+            break;
+        }
+
+        while(first < last && first % DEPTH_HIERARCHY_FANOUT != 0) result = std::max(result, depths[first++]);
+        while(last > first && last % DEPTH_HIERARCHY_FANOUT != 0) result = std::max(result, depths[--last]);
+
+        first /= DEPTH_HIERARCHY_FANOUT;
+        last /= DEPTH_HIERARCHY_FANOUT;
+    }
+
+    return result;
+}
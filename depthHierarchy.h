@@ -0,0 +1,32 @@
+#ifndef DEPTH_HIERARCHY_H
+#define DEPTH_HIERARCHY_H
+
+#include <vector>
+
+// Number of columns merged at each level (8, 64, 512...)
+const unsigned int DEPTH_HIERARCHY_FANOUT = 8;
+
+// Max-depth pyramid over the per-column wall distances (the ZBuffer).
+// Level 0 is the ZBuffer itself, and each entry of the next level holds the
+// farthest wall of DEPTH_HIERARCHY_FANOUT entries of the previous one. A
+// sprite is hidden when it is behind the farthest wall of all its columns,
+// which takes a handful of lookups even for sprites that cover the screen.
+class DepthHierarchy
+{
+public:
+    DepthHierarchy() { }
+
+    // Rebuilds every level from the ZBuffer of the frame
+    void Build(const std::vector<float>& zBuffer);
+
+    // Farthest wall distance inside the columns [first, last)
+    float MaxDepth(int first, int last) const;
+
+    // True when the walls hide every column [first, last) at this depth
+    bool Occluded(int first, int last, float depth) const { return first >= last || depth > this->MaxDepth(first, last); }
+
+private:
+    std::vector<std::vector<float>> levels;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#include "depthTexture.h"
+#include "glState.h"
+
+#include <algorithm>
+#include <limits>
+
+
+void DepthTexture::Generate(unsigned int width)
+{
+    this->Width = width;
+
+    // Every texel is fetched exactly, so no filtering and no wrapping
+    GLState::BindTexture(GL_TEXTURE_2D, this->Object.Get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, 1, 0, GL_RED, GL_FLOAT, nullptr);
+    this->Object.SetBytes(GLObjects::TextureBytes(GL_R32F, width, 1));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // The new storage is undefined, so the next upload has to send every column
+    this->uploaded.assign(width, std::numeric_limits<float>::quiet_NaN());
+}
+
+void DepthTexture::Upload(const std::vector<float>& depth)
+{
+    unsigned int count = std::min(static_cast<unsigned int>(depth.size()), this->Width);
+
+    // Span of the columns that changed since the last frame (NaN never compares equal)
+    unsigned int first = 0;
+    while(first < count && depth[first] == this->uploaded[first]) first++;
+
+    this->LastUploadColumns = 0;
+    if(first == count) return;
+
+    unsigned int last = count - 1;
+    while(last > first && depth[last] == this->uploaded[last]) last--;
+
+    std::copy(depth.begin() + first, depth.begin() + last + 1, this->uploaded.begin() + first);
+    this->LastUploadColumns = last - first + 1;
+
+    GLState::BindTexture(GL_TEXTURE_2D, this->Object.ID());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, first, 0, this->LastUploadColumns, 1, GL_RED, GL_FLOAT, depth.data() + first);
+}
+
+void DepthTexture::Bind() const
+{
+    GLState::BindTexture(GL_TEXTURE_2D, this->Object.ID());
+}
@@ -0,0 +1,37 @@
+#ifndef DEPTH_TEXTURE_H
+#define DEPTH_TEXTURE_H
+
+#include <vector>
+
+#include "glad/glad.h"
+#include "glObject.h"
+
+// One row R32F texture holding the wall distance of every screen column,
+// so the sprite fragment shader can read the ZBuffer with texelFetch
+// whatever the resolution is. A copy of the last upload is kept on the CPU
+// and only the span of columns that changed since then is sent to the GPU.
+class DepthTexture
+{
+public:
+    // owns the texture object
+    GLTexture Object;
+    // number of columns
+    unsigned int Width = 0;
+
+    DepthTexture() { }
+
+    // allocates the storage for width columns (it can be called again when the view is resized)
+    void Generate(unsigned int width);
+    // uploads the columns that differ from the previous upload
+    void Upload(const std::vector<float>& depth);
+    // binds the texture as the current active GL_TEXTURE_2D texture object
+    void Bind() const;
+
+    // Columns sent by the last upload (0 when nothing changed)
+    unsigned int LastUploadColumns = 0;
+
+private:
+    std::vector<float> uploaded; // Depth currently stored in the texture
+};
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef FLOOR_PROJECTION_H
+#define FLOOR_PROJECTION_H
+
+#include <cmath>
+
+// Horizontal distance from the camera to the floor (or ceiling) seen by a screen row.
+// The camera is at half the screen height and the distance from the camera to the
+// screen is always 1, so by triangle equivalence a row p pixels away from the horizon
+// sees the floor at rowDistance/1 = posZ/p. Used by the GL floor casting and by the
+// software renderer, so both backends place the floor texels at the same distance.
+// The horizon row itself (p = 0) is infinitely far away.
+inline float FloorRowDistance(float screenHeight, float row)
+{
+    float posZ = 0.5f * screenHeight; // Vertical position of the camera in pixels
+    return posZ / std::abs(row - posZ);
+}
+
+#endif
@@ -0,0 +1,53 @@
+#include "frameUniforms.h"
+
+#include <cstddef>
+
+// The C++ struct must match the std140 offsets of the block
+static_assert(offsetof(FrameUniformData, TextProjection) == 64, "Frame block layout");
+static_assert(offsetof(FrameUniformData, ScreenSize) == 128, "Frame block layout");
+static_assert(offsetof(FrameUniformData, ViewWidth) == 136, "Frame block layout");
+static_assert(offsetof(FrameUniformData, ViewStart) == 140, "Frame block layout");
+static_assert(sizeof(FrameUniformData) == 144, "Frame block layout");
+
+void FrameUniforms::Generate(const glm::mat4& projection, const glm::mat4& textProjection, glm::vec2 screenSize)
+{
+    this->Data.Projection = projection;
+    this->Data.TextProjection = textProjection;
+    this->Data.ScreenSize = screenSize;
+    // The 3D view is the right half of the screen
+    this->Data.ViewWidth = screenSize.x / 2.0f;
+    this->Data.ViewStart = screenSize.x / 2.0f;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, this->Object.Get());
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniformData), &this->Data, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    this->Object.SetBytes(sizeof(FrameUniformData));
+
+    // The binding stays for the whole run
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, this->Object.ID());
+}
+
+void FrameUniforms::SetView(float start, float width)
+{
+    this->Data.ViewWidth = width;
+    this->Data.ViewStart = start;
+
+    // Both floats are next to each other in the block
+    glBindBuffer(GL_UNIFORM_BUFFER, this->Object.ID());
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(FrameUniformData, ViewWidth), 2 * sizeof(float), &this->Data.ViewWidth);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FrameUniforms::SetProjection(const glm::mat4& projection)
+{
+    this->Data.Projection = projection;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, this->Object.ID());
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(FrameUniformData, Projection), sizeof(glm::mat4), &this->Data.Projection);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FrameUniforms::Release()
+{
+    this->Object.Reset();
+}
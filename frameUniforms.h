@@ -0,0 +1,52 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include "glad/glad.h"
+#include "glObject.h"
+#include "glm/glm.hpp"
+
+#include "shader.h"
+
+// Values shared by every shader, in the std140 layout of the "Frame" block:
+//
+//   layout (std140) uniform Frame {
+//       mat4 projection;     // Top to bottom screen projection
+//       mat4 textProjection; // Bottom to top projection of the text
+//       vec2 screenSize;     // Size of the game screen in pixels
+//       float viewWidth;     // Width of the 3D view in the pixels of the framebuffer drawn into
+//       float viewStart;     // First x of the 3D view in those pixels
+//   };
+struct FrameUniformData
+{
+    glm::mat4 Projection;
+    glm::mat4 TextProjection;
+    glm::vec2 ScreenSize;
+    float ViewWidth;
+    float ViewStart;
+};
+
+// Uniform buffer holding the FrameUniformData. It is bound once on
+// FRAME_UNIFORM_BINDING and every shader that declares the block reads it
+// from there, so the projection and the screen size are uploaded once
+// instead of once per shader.
+class FrameUniforms
+{
+public:
+    // owns the buffer object
+    GLBuffer Object;
+    // CPU copy of the block
+    FrameUniformData Data;
+
+    FrameUniforms() { }
+
+    // Creates the buffer with the initial values and binds it to its binding point
+    void Generate(const glm::mat4& projection, const glm::mat4& textProjection, glm::vec2 screenSize);
+    // Updates where the 3D view is in the framebuffer pixels (window resized, or drawing into an offscreen target)
+    void SetView(float start, float width);
+    // Replaces the screen projection (to draw into an offscreen target, then back)
+    void SetProjection(const glm::mat4& projection);
+    // Deletes the buffer (Generate creates it again)
+    void Release();
+};
+
+#endif
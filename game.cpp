@@ -1,8 +1,17 @@
 #include "game.h"
 #include "resourceManager.h"
 #include "spriteRenderer.h"
+#include "spriteBatch.h"
+#include "spriteInstanceRenderer.h"
+#include "spriteRasterizer.h"
+#include "threadPool.h"
+#include "spriteClusters.h"
 #include "gameLevel.h"
 #include "playerObject.h"
+#include "frameUniforms.h"
+#include "minimap.h"
+#include "softwareRenderer.h"
+#include "viewTarget.h"
 
 // GLM Mathematics Library headers
 #include "glm/glm.hpp"
@@ -13,21 +22,44 @@
 #include <vector>
 #include <algorithm> 
 #include <filesystem>
+#include <climits>
+#include <cstdlib>
 
 SpriteRenderer *WallRenderer;
 SpriteRenderer *FloorRenderer;
-SpriteRenderer *SpRenderer;
+SpriteInstanceRenderer *SpRenderer;
 SpriteRenderer *MapRenderer;
 SpriteRenderer *PlayerRenderer;
+SpriteRenderer *SkyRenderer;
+SpriteRenderer *SpriteLayerRenderer;
+// Presents the indexed software framebuffer through the palette (--palette on)
+SpriteRenderer *PaletteRenderer;
+// Vertex buffer shared by the 2D renderers
+SpriteBatch *Batch;
+// Cached map of the left panel
+Minimap *LevelMap;
+// Offscreen target of the 3D view at its internal resolution, and the renderer that stretches it
+ViewTarget     *View3D;
+SpriteRenderer *UpscaleRenderer;
+
+// Projection and screen size shared by all the shaders
+FrameUniforms FrameData;
+
+// CPU sprite path (--sprites cpu)
+ThreadPool       *Workers;
+SpriteRasterizer *SpRasterizer;
+// CPU backend of the whole 3D view (--renderer software)
+SoftwareRenderer *SwRenderer;
 
 
 // Player stats
 PlayerObject *Player;
 
-GameObject  *wallObj;
 GameObject  *floorObj;
-GameObject  *spriteObj;
+GameObject  *skyObj;
+GameObject  *spriteLayerObj;
 Texture2D   *floorTexture;
+Texture2D   *spriteLayerTexture;
 
 //Scale of the level map in the grid size
 float mapScale;
@@ -41,6 +73,29 @@ unsigned int mapSizeGridY;
 // RayDensity = How thick is each wall slice
 unsigned int rayDensity = 1;
 
+// Memory order of the texels sampled by the floor casting (--texels option)
+TexelLayout texelLayout = TEXEL_ROW_MAJOR;
+
+// Texture drawn behind the open ceiling cells (--sky option)
+int skyTexture = 1;
+bool skyTextureSet = false; // Picked by the user, so it must exist even without sky cells
+
+// Draws the sprites with the CPU rasterizer instead of the GPU (--sprites option)
+bool cpuSprites = false;
+
+// Draws the far sprite clusters as impostors (--impostors option)
+bool useImpostors = false;
+
+// Composes the 3D view on the CPU instead of drawing it with GL (--renderer option)
+bool softwareRendering = false;
+// The software framebuffer holds 8-bit palette indices instead of RGBA (--palette option)
+bool indexedColor = false;
+
+// Internal resolution of the 3D view as a fraction of the native one, and how it is stretched
+// (--resolution and --upscale options, F2 / F3 / F4 at runtime)
+float viewScale = 1.0f;
+UpscaleFilter upscaleFilter = UPSCALE_SHARP_BILINEAR;
+
 namespace fs = std::filesystem;
 
 
@@ -52,17 +107,59 @@ Game::Game(unsigned int width, unsigned int height)
 
 Game::~Game()
 {
+    this->Release();
+}
+
+void Game::Release()
+{
+    // Each pointer is cleared, so releasing twice (main, then the destructor) is harmless
+    delete RayCaster;
+    RayCaster = nullptr;
     delete WallRenderer;
+    WallRenderer = nullptr;
     delete FloorRenderer;
+    FloorRenderer = nullptr;
     delete SpRenderer;
+    SpRenderer = nullptr;
+    delete MapRenderer;
+    MapRenderer = nullptr;
     delete PlayerRenderer;
+    PlayerRenderer = nullptr;
+    delete SkyRenderer;
+    SkyRenderer = nullptr;
+    delete SpriteLayerRenderer;
+    SpriteLayerRenderer = nullptr;
+    delete PaletteRenderer;
+    PaletteRenderer = nullptr;
+    delete LevelMap;
+    LevelMap = nullptr;
+    delete View3D;
+    View3D = nullptr;
+    delete UpscaleRenderer;
+    UpscaleRenderer = nullptr;
+    delete Batch;
+    Batch = nullptr;
+    delete SwRenderer;
+    SwRenderer = nullptr;
+    delete SpRasterizer;
+    SpRasterizer = nullptr;
+    delete Workers;
+    Workers = nullptr;
     delete Player;
-    delete wallObj;
+    Player = nullptr;
     delete floorObj;
-    delete spriteObj;
+    floorObj = nullptr;
+    delete skyObj;
+    skyObj = nullptr;
+    delete spriteLayerObj;
+    spriteLayerObj = nullptr;
 
     delete floorTexture;
     floorTexture = nullptr;
+    delete spriteLayerTexture;
+    spriteLayerTexture = nullptr;
+
+    FrameData.Release();
 }
 
 void Game::Init(int argc, char* argv[])
@@ -72,10 +169,98 @@ void Game::Init(int argc, char* argv[])
     if (argc < 5) {
         std::cerr << "Usage: " << argv[0]
                   << " <level.lvl> <level.flo> <level.cel> <level.ele>"
+                  << " [--texels linear|tiled|morton] [--sky <texture>] [--sprites gpu|cpu] [--impostors on|off]"
+                  << " [--renderer gl|software] [--palette on|off] [--resolution <scale>] [--upscale nearest|sharp] [--headless [--frames <count>] [--camera <path file>] [--output <image.ppm>]]"
                   << std::endl;
         exit(1);
     }
 
+    // Optional arguments after the level files
+    for (int i = 5; i < argc; i++) {
+        std::string option = argv[i];
+
+        if (option == "--texels" && i + 1 < argc) {
+            if (!ParseTexelLayout(argv[++i], texelLayout)) {
+                std::cerr << "Error: unknown texel layout -> " << argv[i] << std::endl;
+                exit(1);
+            }
+        }
+        else if (option == "--sky" && i + 1 < argc) {
+            // Texture numbers are the file names inside Textures/
+            char* end = nullptr;
+            long id = std::strtol(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || id <= 0 || id > INT_MAX) {
+                std::cerr << "Error: the sky texture must be a texture number -> " << argv[i] << std::endl;
+                exit(1);
+            }
+            skyTexture = static_cast<int>(id);
+            skyTextureSet = true;
+        }
+        else if (option == "--sprites" && i + 1 < argc) {
+            std::string backend = argv[++i];
+            if (backend != "gpu" && backend != "cpu") {
+                std::cerr << "Error: unknown sprite backend -> " << backend << std::endl;
+                exit(1);
+            }
+            cpuSprites = backend == "cpu";
+        }
+        else if (option == "--impostors" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode != "on" && mode != "off") {
+                std::cerr << "Error: unknown impostor mode -> " << mode << std::endl;
+                exit(1);
+            }
+            useImpostors = mode == "on";
+        }
+        else if (option == "--renderer" && i + 1 < argc) {
+            std::string backend = argv[++i];
+            if (backend != "gl" && backend != "software") {
+                std::cerr << "Error: unknown renderer -> " << backend << std::endl;
+                exit(1);
+            }
+            softwareRendering = backend == "software";
+        }
+        else if (option == "--palette" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode != "on" && mode != "off") {
+                std::cerr << "Error: unknown palette mode -> " << mode << std::endl;
+                exit(1);
+            }
+            indexedColor = mode == "on";
+        }
+        else if (option == "--resolution" && i + 1 < argc) {
+            viewScale = static_cast<float>(std::atof(argv[++i]));
+            if (viewScale < VIEW_MIN_SCALE || viewScale > 1.0f) {
+                std::cerr << "Error: the resolution scale must be between " << VIEW_MIN_SCALE << " and 1 -> " << argv[i] << std::endl;
+                exit(1);
+            }
+        }
+        else if (option == "--upscale" && i + 1 < argc) {
+            std::string filter = argv[++i];
+            if (filter != "nearest" && filter != "sharp") {
+                std::cerr << "Error: unknown upscale filter -> " << filter << std::endl;
+                exit(1);
+            }
+            upscaleFilter = filter == "nearest" ? UPSCALE_NEAREST : UPSCALE_SHARP_BILINEAR;
+        }
+        else {
+            std::cerr << "Error: unknown option -> " << option << std::endl;
+            exit(1);
+        }
+    }
+
+    // Only the software framebuffer can be indexed
+    if (indexedColor && !softwareRendering) {
+        std::cerr << "Error: --palette on needs --renderer software" << std::endl;
+        exit(1);
+    }
+
+    // The software framebuffer keeps the game resolution, so it never goes through the scaled target
+    if (viewScale != 1.0f && softwareRendering) {
+        std::cerr << "Error: --resolution below 1 needs --renderer gl" << std::endl;
+        exit(1);
+    }
+
     // Validate the file paths
     for (int i = 1; i <= 4; i++) {
         if (!fs::exists(argv[i])) {
@@ -86,12 +271,16 @@ void Game::Init(int argc, char* argv[])
 
 
     // load shaders
-    ResourceManager::LoadShader("Shaders/shaderCoordinate.vs", "Shaders/shaderWall.fs", nullptr, "wall");
-    ResourceManager::LoadShader("Shaders/shaderCoordinate.vs", "Shaders/shaderFloor.fs", nullptr, "floor");
-    ResourceManager::LoadShader("Shaders/shaderText.vs", "Shaders/shaderText.fs", nullptr, "text");
-    ResourceManager::LoadShader("Shaders/shaderSprite.vs", "Shaders/shaderSprite.fs", nullptr, "sprite");
-    ResourceManager::LoadShader("Shaders/shaderCoordinate.vs", "Shaders/shaderCoordinate.fs", nullptr, "map");
-    ResourceManager::LoadShader("Shaders/shaderCoordinate.vs", "Shaders/shaderPlayer.fs", nullptr, "player");
+    ShaderHandle wallShader = ResourceManager::LoadShader("Shaders/shaderCoordinate.vs", "Shaders/shaderCoordinate.fs", nullptr, "wall");
+    ShaderHandle floorShader = ResourceManager::LoadShader("Shaders/shaderCoordinate.vs", "Shaders/shaderFloor.fs", nullptr, "floor");
+    ShaderHandle textShader = ResourceManager::LoadShader("Shaders/shaderText.vs", "Shaders/shaderText.fs", nullptr, "text");
+    ShaderHandle spriteShader = ResourceManager::LoadShader("Shaders/shaderSprite.vs", "Shaders/shaderSprite.fs", nullptr, "sprite");
+    ShaderHandle mapShader = ResourceManager::LoadShader("Shaders/shaderCoordinate.vs", "Shaders/shaderCoordinate.fs", nullptr, "map");
+    ShaderHandle playerShader = ResourceManager::LoadShader("Shaders/shaderCoordinate.vs", "Shaders/shaderPlayer.fs", nullptr, "player");
+    ShaderHandle skyShader = ResourceManager::LoadShader("Shaders/shaderCoordinate.vs", "Shaders/shaderSky.fs", nullptr, "sky");
+    ShaderHandle spriteLayerShader = ResourceManager::LoadShader("Shaders/shaderCoordinate.vs", "Shaders/shaderCoordinate.fs", nullptr, "spriteLayer");
+    ShaderHandle paletteShader = ResourceManager::LoadShader("Shaders/shaderCoordinate.vs", "Shaders/shaderPalette.fs", nullptr, "palette");
+    ShaderHandle upscaleShader = ResourceManager::LoadShader("Shaders/shaderCoordinate.vs", "Shaders/shaderUpscale.fs", nullptr, "upscale");
 
    // Define the View Matrix - Game is oriented from top to bottom
     glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->Width), static_cast<float>(this->Height), 0.0f, -1.0f, 1.0f);
@@ -120,36 +309,40 @@ void Game::Init(int argc, char* argv[])
     */
    
    
+   // The projections and the screen size go once in the shared uniform block
+   // (the viewport width is the screen width until the window reports its framebuffer size)
+   FrameData.Generate(projection, textProjection, glm::vec2(this->Width, this->Height));
+
    // Set the uniform values on each shader    
-   ResourceManager::GetShader("wall").Use().SetInt("image", 0);
-   ResourceManager::GetShader("wall").SetMat4("projection", projection);
-   ResourceManager::GetShader("floor").Use().SetInt("image", 0);
-   ResourceManager::GetShader("floor").SetMat4("projection", projection);
-   ResourceManager::GetShader("sprite").Use().SetInt("image", 0);
-   ResourceManager::GetShader("sprite").SetMat4("projection", projection);
-   ResourceManager::GetShader("sprite").SetFloat("screenWidth", static_cast<float>(this->Width)); // Pass the screen width to the sprite fragment shader
-   ResourceManager::GetShader("text").Use().SetMat4("text", 0);
-   ResourceManager::GetShader("text").SetMat4("projection", textProjection);
-   ResourceManager::GetShader("map").Use().SetInt("image", 0);
-   ResourceManager::GetShader("map").SetMat4("projection", projection);
-   ResourceManager::GetShader("player").Use().SetInt("image", 0);
-   ResourceManager::GetShader("player").SetMat4("projection", projection);
+   ResourceManager::GetShader(wallShader).Use().SetInt("image", 0);
+   ResourceManager::GetShader(floorShader).Use().SetInt("image", 0);
+   ResourceManager::GetShader(spriteShader).Use().SetInt("image", 0);
+   ResourceManager::GetShader(spriteShader).SetInt("depthMap", 1); // The ZBuffer texture is on the second unit
+   ResourceManager::GetShader(textShader).Use().SetInt("text", 0);
+   ResourceManager::GetShader(mapShader).Use().SetInt("image", 0);
+   ResourceManager::GetShader(playerShader).Use().SetInt("image", 0);
+   ResourceManager::GetShader(skyShader).Use().SetInt("image", 0);
+   ResourceManager::GetShader(spriteLayerShader).Use().SetInt("image", 0);
+   ResourceManager::GetShader(paletteShader).Use().SetInt("image", 0);
+   ResourceManager::GetShader(paletteShader).SetInt("palette", 1); // The palette texture is on the second unit
+   ResourceManager::GetShader(upscaleShader).Use().SetInt("image", 0);
    
    // Set render-specific controls
-   Shader Shader = ResourceManager::GetShader("wall");
-   WallRenderer = new SpriteRenderer(Shader);
-   
-   Shader = ResourceManager::GetShader("floor");
-   FloorRenderer = new SpriteRenderer(Shader);
-
-   Shader = ResourceManager::GetShader("sprite");
-   SpRenderer = new SpriteRenderer(Shader);
-
-   Shader = ResourceManager::GetShader("map");
-   MapRenderer = new SpriteRenderer(Shader);
-
-   Shader = ResourceManager::GetShader("player");
-   PlayerRenderer = new SpriteRenderer(Shader);
+   Batch = new SpriteBatch();
+   WallRenderer = new SpriteRenderer(ResourceManager::GetShader(wallShader), *Batch);
+   FloorRenderer = new SpriteRenderer(ResourceManager::GetShader(floorShader), *Batch);
+   SpRenderer = new SpriteInstanceRenderer(ResourceManager::GetShader(spriteShader));
+   MapRenderer = new SpriteRenderer(ResourceManager::GetShader(mapShader), *Batch);
+   PlayerRenderer = new SpriteRenderer(ResourceManager::GetShader(playerShader), *Batch);
+   SkyRenderer = new SpriteRenderer(ResourceManager::GetShader(skyShader), *Batch);
+   SpriteLayerRenderer = new SpriteRenderer(ResourceManager::GetShader(spriteLayerShader), *Batch);
+   PaletteRenderer = new SpriteRenderer(ResourceManager::GetShader(paletteShader), *Batch);
+   // The map fills the left half of the screen
+   LevelMap = new Minimap(*MapRenderer, FrameData, glm::vec2(this->Width/2, this->Height));
+   // The 3D view fills the right half, its target gets its size with the first Resize
+   UpscaleRenderer = new SpriteRenderer(ResourceManager::GetShader(upscaleShader), *Batch);
+   View3D = new ViewTarget(*UpscaleRenderer, ResourceManager::GetShader(upscaleShader), FrameData,
+                           glm::vec2(this->Width/2, 0.0f), glm::vec2(this->Width/2, this->Height), viewScale, upscaleFilter);
 
    // ========================= Buffers =======================================
    
@@ -159,14 +352,17 @@ void Game::Init(int argc, char* argv[])
    
    // =================== Load textures ========================================
    
-   ResourceManager::LoadTextures("Textures/");
+   // The impostors need some spare texture layers to be composed at runtime
+   // The indexed framebuffer needs the palette and the indices of every texture
+   ResourceManager::LoadTextures("Textures/", texelLayout, useImpostors ? SPRITE_IMPOSTOR_LAYERS : 0, indexedColor);
    
-   floorTexture = new Texture2D();
+   // The floor buffer carries alpha, the sky cells are left transparent
+   floorTexture = new Texture2D(GL_RGBA, GL_RGBA, GL_REPEAT, GL_REPEAT, GL_LINEAR, GL_LINEAR);
    
    // Initialize GameObjects
-   wallObj = new GameObject();
    floorObj = new GameObject();
-   spriteObj = new GameObject();
+   skyObj = new GameObject();
+   spriteLayerObj = new GameObject();
    
    // load levels
    GameLevel one; 
@@ -179,6 +375,15 @@ void Game::Init(int argc, char* argv[])
     mapSizeGridX = this->Levels[this->Level].tileData[0].size();
     mapSizeGridY = this->Levels[this->Level].tileData.size();
 
+    // The sky texture is only used by levels with open ceiling cells
+    if (skyTextureSet || this->Levels[this->Level].HasSky) {
+        if (ResourceManager::Textures.count(skyTexture) == 0) {
+            std::cerr << "Error: sky texture not found -> " << skyTexture << std::endl;
+            exit(1);
+        }
+        skyObj->Sprite = ResourceManager::GetTexture(skyTexture);
+    }
+
     // Resize the spriteDistance based on the numbers of sprites avaiable
     this->numSprites = Levels[Level].elementsInfo.size();
     this->spriteDistance.resize(numSprites);
@@ -210,99 +415,135 @@ void Game::Init(int argc, char* argv[])
         WallRenderer,
         FloorRenderer,
         SpRenderer,
+        SkyRenderer,
     //==========================
     // Game Objects
-        wallObj,
         floorObj,
-        spriteObj,
+        skyObj,
     //==========================
     // Textures
         floorTexture
     );
 
-}
+    if (useImpostors)
+        RayCaster->EnableImpostors();
+
+    // Both CPU paths rasterize the sprites in parallel
+    if (cpuSprites || softwareRendering) {
+        Workers = new ThreadPool();
+        SpRasterizer = new SpriteRasterizer(this->Width/2, this->Height, Workers);
+    }
+
+    // The software backend composes the whole view (sprites included) into one framebuffer
+    if (softwareRendering) {
+        if (indexedColor) {
+            SwRenderer = new SoftwareRenderer(this->Width/2, this->Height, Workers, &ResourceManager::ColorPalette);
+            RayCaster->EnableSoftwareRenderer(SwRenderer, SpRasterizer, PaletteRenderer);
+        }
+        else {
+            SwRenderer = new SoftwareRenderer(this->Width/2, this->Height, Workers);
+            RayCaster->EnableSoftwareRenderer(SwRenderer, SpRasterizer, SpriteLayerRenderer);
+        }
+    }
+    // The CPU sprites are drawn as one layer over the walls
+    else if (cpuSprites) {
+        spriteLayerTexture = new Texture2D(GL_RGBA, GL_RGBA, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_NEAREST, GL_NEAREST);
+        RayCaster->EnableCpuSprites(SpRasterizer, SpriteLayerRenderer, spriteLayerObj, spriteLayerTexture);
+    }
 
-void Game::Update(float dt)
-{
-    
 }
 
-void Game::ProcessInput(float dt)
+void Game::MovePlayer(glm::vec2 step)
 {
-    float velocity = Player->velocity *dt;
-    float rotSpeed = Player->rotSpeed *dt;
-
-// ========== MOVING FORWARD =============================
+    GameLevel& level = Levels[Level];
 
-    if (this -> Keys[GLFW_KEY_W]) { 
-        
     // Predict next position
-    glm::vec2 nextPosition = glm::vec2(Player->Position.x + velocity * Player->direction.x,
-                                       Player->Position.y + velocity * Player->direction.y);
-    
+    glm::vec2 nextPosition = Player->Position + step;
 
     // Convert to map grid coords
-    glm::vec2 playerGrid = glm::vec2(Player->Position.x / mapScale,
-                                     Player->Position.y / mapScale);
-
+    glm::vec2 playerGrid = Player->Position / mapScale;
+    glm::vec2 gridStep = step / mapScale;
 
     // Vector that checks the hit box position in the grid for the nextMove
-    glm::vec2 checkPos = glm::vec2((nextPosition.x/mapScale) + (Player->direction.x > 0 ? Player->hitbox : -Player->hitbox),
-                                   (nextPosition.y/mapScale) + (Player->direction.y > 0 ? Player->hitbox : -Player->hitbox));
+    glm::vec2 checkPos = glm::vec2((nextPosition.x/mapScale) + (step.x > 0 ? Player->hitbox : -Player->hitbox),
+                                   (nextPosition.y/mapScale) + (step.y > 0 ? Player->hitbox : -Player->hitbox));
 
-    
-    // Check on each axis if the player can move. If does, than change the player position to that axis
+    // Check on each axis if the player can move, against the walls and the solid sprites around it.
+    // Moving one axis at a time lets the player slide along what blocks the other one
     // ---- X AXIS --------
-    if(Levels[Level].tileData[static_cast<int>(playerGrid.y)][static_cast<int>(checkPos.x)] == 0) {
+    if(level.tileData[static_cast<int>(playerGrid.y)][static_cast<int>(checkPos.x)] == 0 &&
+       !level.collisionGrid.Blocked(playerGrid, glm::vec2(gridStep.x, 0.0f), Player->hitbox)) {
         // Apply translation based on the position of the player
-        Player->Position.x = nextPosition.x;   
+        Player->Position.x = nextPosition.x;
     }
 
     // ---- Y AXIS --------
-    if(Levels[Level].tileData[static_cast<int>(checkPos.y)][static_cast<int>(playerGrid.x)] == 0) {
+    // The sprites are tested from where the X move left the player
+    glm::vec2 movedGrid = Player->Position / mapScale;
+    if(level.tileData[static_cast<int>(checkPos.y)][static_cast<int>(playerGrid.x)] == 0 &&
+       !level.collisionGrid.Blocked(movedGrid, glm::vec2(0.0f, gridStep.y), Player->hitbox)) {
         // Apply translation based on the position of the player
         Player->Position.y = nextPosition.y;
-   
-    }
-   
-        //printf("X: %.2f , Y: %.2f\n", Player->Position.x/mapScale, Player->Position.y/mapScale);
-        //printf("mapX: %d , mapY: %d\n", mapx, mapy);
     }
+}
 
-// ========== MOVING BACKWARS =============================
-    if (this -> Keys[GLFW_KEY_S]) { 
+void Game::Resize(int width, int height)
+{
+    // The sprite fragment shader maps the window pixels to the ray columns (the view is the right half)
+    FrameData.SetView(width / 2.0f, width / 2.0f);
+    // The native resolution of the 3D view follows the framebuffer
+    View3D->Resize(width, height);
+}
 
-    // Predict next position
-        glm::vec2 nextPosition = glm::vec2(Player->Position.x - velocity * Player->direction.x,
-                                           Player->Position.y - velocity * Player->direction.y);
+void Game::ChangeViewScale(float step)
+{
+    // The software view is always drawn at the game resolution
+    if (softwareRendering) return;
+
+    // Nothing is allocated, the next frame just draws a different corner of the target
+    View3D->SetScale(View3D->Scale + step);
+}
+
+void Game::SwitchUpscaleFilter()
+{
+    View3D->SetFilter(View3D->Filter == UPSCALE_NEAREST ? UPSCALE_SHARP_BILINEAR : UPSCALE_NEAREST);
+}
 
+const ViewTarget& Game::View() const
+{
+    return *View3D;
+}
 
-        // Convert to map grid coords
-        glm::vec2 playerGrid = glm::vec2(Player->Position.x / mapScale,
-                                         Player->Position.y / mapScale);
+void Game::SetCamera(glm::vec2 position, float angle)
+{
+    Player->Position = position * mapScale;
 
+    // The plane keeps its length (the field of view) and stays perpendicular to the direction
+    float radians = glm::radians(angle);
+    float planeLength = glm::length(Player->plane);
+    Player->direction = glm::vec2(std::cos(radians), std::sin(radians));
+    Player->plane = glm::vec2(Player->direction.y, -Player->direction.x) * planeLength;
+}
 
-        // Vector that checks the hit box position in the grid for the nextMove
-        glm::vec2 checkPos = glm::vec2((nextPosition.x/mapScale) + (Player->direction.x < 0 ? Player->hitbox : -Player->hitbox),
-                                       (nextPosition.y/mapScale) + (Player->direction.y < 0 ? Player->hitbox : -Player->hitbox));
+void Game::Update(float dt)
+{
+    
+}
 
+void Game::ProcessInput(float dt)
+{
+    float velocity = Player->velocity *dt;
+    float rotSpeed = Player->rotSpeed *dt;
 
-        // Check on each axis if the player can move. If does, than change the player position to that axis
-        // ---- X AXIS --------
-        if(Levels[Level].tileData[static_cast<int>(playerGrid.y)][static_cast<int>(checkPos.x)] == 0) {
-            // Apply translation based on the position of the player
-            Player->Position.x = nextPosition.x;  
-        }
+// ========== MOVING FORWARD =============================
 
-        // ---- Y AXIS --------
-        if(Levels[Level].tileData[static_cast<int>(checkPos.y)][static_cast<int>(playerGrid.x)] == 0) {
-            // Apply translation based on the position of the player
-            Player->Position.y = nextPosition.y;
-        }
+    if (this -> Keys[GLFW_KEY_W]) { 
+        MovePlayer(velocity * Player->direction);
+    }
 
-        //printf("X: %.2f , Y: %.2f\n", Player->Position.x/mapScale, Player->Position.y/mapScale);
-        //printf("mapX: %d , mapY: %d\n", mapx, mapy);
-       
+// ========== MOVING BACKWARS =============================
+    if (this -> Keys[GLFW_KEY_S]) { 
+        MovePlayer(-velocity * Player->direction);
     }
     if (this -> Keys[GLFW_KEY_A]) { 
         
@@ -381,11 +622,22 @@ void Game::Render()
    
     // Draw Level Map in the first half of the screen
 
-    RayCaster->FloorCeilingCasting();
-    RayCaster->WallCasting(this->ZBuffer);
-    RayCaster->SpriteCasting(this->ZBuffer);
-    this->Levels[this->Level].DrawMap(*MapRenderer);
-    Player->Draw(*PlayerRenderer);
+    // The 3D view, composed on the CPU at the game resolution or drawn with GL at its internal resolution
+    if (softwareRendering) {
+        RayCaster->SoftwareCasting(this->ZBuffer);
+    }
+    else {
+        View3D->Begin();
+        RayCaster->SkyCasting();
+        RayCaster->FloorCeilingCasting();
+        RayCaster->WallCasting(this->ZBuffer);
+        RayCaster->SpriteCasting(this->ZBuffer);
+        View3D->End();
+    }
+    // The map is only drawn again when the level changes or its window scrolls by a cell
+    LevelMap->Update(this->Levels[this->Level], Player->Position);
+    LevelMap->Draw();
+    LevelMap->DrawMarker(*PlayerRenderer, *Player);
     
 }
 
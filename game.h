@@ -10,6 +10,8 @@
 #include <iostream>
 #include <vector>
 
+class ViewTarget;
+
 enum GameState {
     GAME_ACTIVE,
     GAME_MENU,
@@ -27,6 +29,7 @@ class Game {
 
     // FLAGS
     bool keyChartOn = false;
+    bool renderStatsOn = false; // GL counters overlay, toggled with F1
 
     // ZBuffer
     std::vector<float> ZBuffer;
@@ -60,6 +63,26 @@ class Game {
     void Update(float dt);
     void Render();
 
+    // Called when the framebuffer changes size
+    void Resize(int width, int height);
+
+    // Changes the internal resolution of the 3D view by step (a fraction of the native one)
+    void ChangeViewScale(float step);
+    // Switches the upscale filter of the 3D view between nearest and sharp bilinear
+    void SwitchUpscaleFilter();
+    // The target of the 3D view (internal resolution, scale and filter)
+    const ViewTarget& View() const;
+
+    // Places the player at position (in map cells) looking at angle (in degrees, 0 looks along +x)
+    void SetCamera(glm::vec2 position, float angle);
+
+    // Deletes the renderers and everything else holding GL objects (while the context still exists)
+    void Release();
+
+    private:
+    // Moves the player by step (in pixels), stopping each axis on walls and solid sprites
+    void MovePlayer(glm::vec2 step);
+
 };
 
 #endif
\ No newline at end of file
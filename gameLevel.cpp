@@ -13,6 +13,8 @@ void GameLevel::Load(const char *mapFile, const char *floorFile, const char *cei
                      unsigned int screenWidth, unsigned int screenHeight)
 {
     // clear old data
+    this->Generation++;
+    this->HasSky = false;
     this->tileInfo.clear();
     this->elementsInfo.clear();
     this->floorInfo.clear();
@@ -122,16 +124,6 @@ void GameLevel::Load(const char *mapFile, const char *floorFile, const char *cei
 
 }
 
-void GameLevel::DrawMap(SpriteRenderer &renderer)
-{
-    // Draw the map once at the left
-    for (auto &row : this->tileInfo) {
-        for(GameObject& tile : row) {
-            tile.Draw(renderer);
-        }
-    }
-}
-
 
 void GameLevel::init(unsigned int screenWidth, unsigned int screenHeight)
 {
@@ -151,6 +143,10 @@ void GameLevel::init(unsigned int screenWidth, unsigned int screenHeight)
     //printf("%f", unit_width);
     //printf("%f", unit_height);
 
+    // Sky cells keep SIZE_MAX, the floor casting never reads their ceiling texels
+    this->floorTexels.assign(mapWidth * mapHeight, SIZE_MAX);
+    this->ceilingTexels.assign(mapWidth * mapHeight, SIZE_MAX);
+
     // read throught the array of tile data
     for( int i = 0;i < mapHeight; i++)
     {
@@ -158,17 +154,25 @@ void GameLevel::init(unsigned int screenWidth, unsigned int screenHeight)
         {
 
             // Assign the floor/ceiling tiles with the matching texture
-                Texture2D pickedTexture;
+                TextureHandle pickedTexture;
                 // Define the floor texture
                 pickedTexture = ResourceManager::GetTexture(this->floorData[i][j]);
                 this->floorInfo[i][j].Sprite = pickedTexture;
                 this->floorInfo[i][j].IsSolid = true; // Save the floor info
+                this->floorTexels[i * mapWidth + j] = pickedTexture->ArenaOffset;
                    
                    
                 // Define the ceiling texure
-                pickedTexture = ResourceManager::GetTexture(this->ceilingData[i][j]);
-                this->ceilingInfo[i][j].Sprite = pickedTexture;
-                this->ceilingInfo[i][j].IsSolid = true; // Save the ceiling info
+                // Sky cells have no ceiling, the sky is drawn once for the whole screen
+                if(this->ceilingData[i][j] == SKY_CELL) {
+                    this->HasSky = true;
+                }
+                else {
+                    pickedTexture = ResourceManager::GetTexture(this->ceilingData[i][j]);
+                    this->ceilingInfo[i][j].Sprite = pickedTexture;
+                    this->ceilingInfo[i][j].IsSolid = true; // Save the ceiling info
+                    this->ceilingTexels[i * mapWidth + j] = pickedTexture->ArenaOffset;
+                }
                    
                 if(this->tileData[i][j] >= 1)
                 {
@@ -186,6 +190,11 @@ void GameLevel::init(unsigned int screenWidth, unsigned int screenHeight)
                         this->tileInfo[i][j] = wallObj; // Save the tile info
                            
                     }
+                    else {
+                        // The wall casting reads the size of the texture of every wall it hits
+                        std::cerr << "ERROR::GameLevel: wall texture " << this->tileData[i][j] << " does not exist" << std::endl;
+                        throw std::runtime_error("Wall texture not found");
+                    }
                 }
                 else {
                     this->tileInfo[i][j].IsSolid = false; // Set the tile as not solid
@@ -220,50 +229,19 @@ void GameLevel::init(unsigned int screenWidth, unsigned int screenHeight)
         // Assign size
         this->elementsInfo[i - 1].Size = glm::vec2(element_width, element_height);
 
-        Texture2D pickedTexture;
+        TextureHandle pickedTexture;
         // Define the floor texture
         pickedTexture = ResourceManager::GetTexture(this->elementData[i][2]);
         // Assign sprite
         this->elementsInfo[i - 1].Sprite = pickedTexture;
-        // Assign solid
-        this->elementsInfo[i - 1].IsSolid = true;
-        // if(this->elementData[i][3])
-        //     this->elementsInfo[i - 1].IsSolid = true;
-        // else
-        //     this->elementsInfo[i - 1].IsSolid = false;
+        // Assign solid: the optional 4th column of the element file (0 = the player walks through it)
+        this->elementsInfo[i - 1].IsSolid = this->elementData[i].size() < 4 || this->elementData[i][3] != 0;
     }
+
+    // Buckets the elements by cell, so the sprite casting only looks at the visible ones
+    this->spriteGrid.Build(this->elementsInfo, mapWidth, mapHeight, unit_width);
+    // And the solid ones again, with their hitboxes, for the player collision
+    this->collisionGrid.Build(this->elementsInfo, mapWidth, mapHeight, unit_width);
     
 
 }
-
-// void GameLevel::BuildCollisionMap(float unit_width, float unit_height) {
-
-//     // Set the size of the collision map based on the mapSize and fill all with zero
-//     this->collisionData.resize(this->tileData.size(), std::vector<unsigned int>(this->tileData[0].size(), 0));
-
-//     // Fill the map postions which there are walls
-//     for(int i = 0; i < this->collisionData.size(); i++) {
-//         for(int j = 0; j < this->collisionData[i].size(); j++) {
-//             this->collisionData[i][j] = this->tileData[i][j];
-//         }
-//     }
-
-//     // finally check if there are solid elements
-//     for(auto &element : this->elementsInfo) {
-//         // if it is solid, fill its space in the map with 1
-//         if(element.IsSolid)
-//             this->collisionData[static_cast<int>(element.Position.y/unit_height)][static_cast<int>(element.Position.x/unit_width)] = 1;
-//     }
-
-
-//     for(int i = 0; i < this->collisionData.size(); i++) {
-//         for(int j = 0; j < this->collisionData[i].size(); j++) {
-//             std::cout << collisionData[i][j] << " ";
-
-//         }
-//         std::cout << std::endl;
-//     }
-//}
-
-
-
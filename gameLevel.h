@@ -8,6 +8,12 @@
 #include "gameObject.h"
 #include "spriteRenderer.h"
 #include "resourceManager.h"
+#include "spriteGrid.h"
+#include "collisionGrid.h"
+
+// Value of the ceiling map that marks an open sky cell
+// Texture ids start at 1, so 0 was not a valid ceiling value before the sky
+const unsigned int SKY_CELL = 0;
 
 
 /// GameLevel holds all Tiles as part of a Breakout level and 
@@ -30,14 +36,21 @@ public:
     std::vector<std::vector<unsigned int>> ceilingData;
     // Matrix that contains the ceiling tiles gameObject information
     std::vector<std::vector<GameObject>> ceilingInfo;
+    // True when at least one ceiling cell is open to the sky
+    bool HasSky = false;
+
+    // Arena offset of the floor / ceiling texture of each cell (row by row), read by the floor casting
+    std::vector<size_t> floorTexels, ceilingTexels;
 
     // elements map data
     std::vector<std::vector<unsigned int>> elementData;
     // Array that contains the sprites/elements gameObject information
     std::vector<GameObject> elementsInfo;
+    // Elements bucketed by map cell
+    SpriteGrid spriteGrid;
 
-    // Scenario colision data
-    std::vector<std::vector<unsigned int>> collisionData;
+    // Solid elements bucketed by map cell, used by the player collision
+    CollisionGrid collisionGrid;
 
     // player initial position
     glm::vec2 PlayerPosition, PlayerSize;
@@ -45,13 +58,14 @@ public:
     // Tile Size
     float tileSize;
 
+    // Bumped by every Load, so the caches built from a level know when it changed
+    unsigned int Generation = 0;
+
     // constructor
     GameLevel() { }
     // loads level from file
     void Load(const char *mapFile, const char* floorFile, const char* ceilingFile, const char *elementFile, unsigned int levelWidth, unsigned int levelHeight);
 
-    // render the level map
-    void DrawMap(SpriteRenderer &renderer);
     /*
     // check if the level is completed (all non-solid tiles are destroyed)
     bool IsCompleted();
@@ -59,9 +73,6 @@ public:
 private:
     // initialize level from tile data
     void init(unsigned int levelWidth, unsigned int levelHeight);
-
-     // Build the collision map
-     //void BuildCollisionMap(float unit_width, float unit_height);
 };
 
 #endif
\ No newline at end of file
@@ -10,9 +10,9 @@ GameObject::GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec
 */
 
 GameObject::GameObject() 
-: Position(0.0f, 0.0f), Size(1.0f, 1.0f), Color(1.0f), Rotation(0.0f), Sprite(), IsSolid(false), Destroyed(false) { }
+: Position(0.0f, 0.0f), Size(1.0f, 1.0f), Pivot(0.5f, 0.5f), Color(1.0f), Rotation(0.0f), Sprite(), IsSolid(false), Destroyed(false) { }
 
-GameObject::GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite ,glm::vec3 color, glm::vec2 velocity, glm::vec2 pivot) 
+GameObject::GameObject(glm::vec2 pos, glm::vec2 size, TextureHandle sprite ,glm::vec3 color, glm::vec2 velocity, glm::vec2 pivot) 
 : Position(pos), Pivot(pivot), Size(size), Sprite(sprite), Color(color), Rotation(0.0f), IsSolid(false), Destroyed(false) { }
 
 void GameObject::Draw(SpriteRenderer &renderer)
@@ -21,11 +21,11 @@ public:
     bool        IsSolid;
     bool        Destroyed;
     // render state
-    Texture2D   Sprite;	
+    TextureHandle Sprite;	
     // constructor(s)
     GameObject();
    // GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
-    GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f), glm::vec2 pivot = glm::vec2(0.5f,0.5f));
+    GameObject(glm::vec2 pos, glm::vec2 size, TextureHandle sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f), glm::vec2 pivot = glm::vec2(0.5f,0.5f));
     // draw sprite
     virtual void Draw(SpriteRenderer &renderer);
 };
@@ -0,0 +1,100 @@
+#include "glObject.h"
+#include "glState.h"
+
+#include <iomanip>
+
+
+// Instantiate static variables
+GLObjectCount GLObjects::Count[GL_OBJECT_KINDS];
+
+
+unsigned int GLObjects::TotalLive()
+{
+    unsigned int total = 0;
+    for(const GLObjectCount& count : Count)
+        total += count.Live;
+    return total;
+}
+
+size_t GLObjects::TotalBytes()
+{
+    size_t total = 0;
+    for(const GLObjectCount& count : Count)
+        total += count.Bytes;
+    return total;
+}
+
+const char* GLObjects::KindName(GLObjectKind kind)
+{
+    switch(kind) {
+        case GL_OBJECT_TEXTURE:      return "textures";
+        case GL_OBJECT_BUFFER:       return "buffers";
+        case GL_OBJECT_VERTEX_ARRAY: return "vertex arrays";
+        case GL_OBJECT_PROGRAM:      return "programs";
+        case GL_OBJECT_FRAMEBUFFER:  return "framebuffers";
+        default:                     return "unknown";
+    }
+}
+
+void GLObjects::Report(std::ostream& out)
+{
+    for(int kind = 0; kind < GL_OBJECT_KINDS; kind++) {
+        out << "  " << std::left << std::setw(14) << KindName(static_cast<GLObjectKind>(kind))
+            << std::right << std::setw(6) << Count[kind].Live
+            << std::setw(10) << std::fixed << std::setprecision(1) << Count[kind].Bytes / 1024.0 << " KiB" << std::endl;
+    }
+    out << "  " << std::left << std::setw(14) << "total"
+        << std::right << std::setw(6) << TotalLive()
+        << std::setw(10) << std::fixed << std::setprecision(1) << TotalBytes() / 1024.0 << " KiB" << std::endl;
+}
+
+size_t GLObjects::TextureBytes(GLenum internalFormat, unsigned int width, unsigned int height, unsigned int depth)
+{
+    // Drivers store the RGB textures with 4 bytes per texel, the estimate does the same
+    size_t texelBytes;
+    switch(internalFormat) {
+        case GL_RED:
+        case GL_R8:
+            texelBytes = 1;
+            break;
+        default: // GL_RGB, GL_RGBA, GL_RGBA8, GL_R32F
+            texelBytes = 4;
+            break;
+    }
+    return texelBytes * width * height * depth;
+}
+
+GLuint GLObjects::Create(GLObjectKind kind)
+{
+    GLuint id = 0;
+    switch(kind) {
+        case GL_OBJECT_TEXTURE:      glGenTextures(1, &id); break;
+        case GL_OBJECT_BUFFER:       glGenBuffers(1, &id); break;
+        case GL_OBJECT_VERTEX_ARRAY: glGenVertexArrays(1, &id); break;
+        case GL_OBJECT_PROGRAM:      id = glCreateProgram(); break;
+        case GL_OBJECT_FRAMEBUFFER:  glGenFramebuffers(1, &id); break;
+        default: break;
+    }
+    Count[kind].Live++;
+    return id;
+}
+
+void GLObjects::Destroy(GLObjectKind kind, GLuint id, size_t bytes)
+{
+    // The names cached as bound go through the state cache
+    switch(kind) {
+        case GL_OBJECT_TEXTURE:      GLState::DeleteTexture(id); break;
+        case GL_OBJECT_BUFFER:       glDeleteBuffers(1, &id); break;
+        case GL_OBJECT_VERTEX_ARRAY: GLState::DeleteVertexArray(id); break;
+        case GL_OBJECT_PROGRAM:      GLState::DeleteProgram(id); break;
+        case GL_OBJECT_FRAMEBUFFER:  glDeleteFramebuffers(1, &id); break;
+        default: break;
+    }
+    Count[kind].Live--;
+    Count[kind].Bytes -= bytes;
+}
+
+void GLObjects::Resize(GLObjectKind kind, size_t oldBytes, size_t newBytes)
+{
+    Count[kind].Bytes += newBytes - oldBytes;
+}
@@ -0,0 +1,122 @@
+#ifndef GL_OBJECT_H
+#define GL_OBJECT_H
+
+#include <cstddef>
+#include <ostream>
+
+#include "glad/glad.h"
+
+// Kinds of GL objects owned through a GLObject
+enum GLObjectKind {
+    GL_OBJECT_TEXTURE,
+    GL_OBJECT_BUFFER,
+    GL_OBJECT_VERTEX_ARRAY,
+    GL_OBJECT_PROGRAM,
+    GL_OBJECT_FRAMEBUFFER,
+    GL_OBJECT_KINDS
+};
+
+// Live objects of one kind and the GPU memory they are estimated to hold
+struct GLObjectCount
+{
+    unsigned int Live = 0;
+    size_t Bytes = 0;
+};
+
+// Accounting of every GL object created through a GLObject. Each creation
+// and deletion is counted, so the numbers are the objects alive right now:
+// loading a level twice, or clearing the resources, must bring them back
+// to where they were.
+class GLObjects
+{
+public:
+    // Live objects per kind
+    static GLObjectCount Count[GL_OBJECT_KINDS];
+
+    // Sums over every kind
+    static unsigned int TotalLive();
+    static size_t TotalBytes();
+    // Name of a kind, for the reports
+    static const char* KindName(GLObjectKind kind);
+    // Writes one line per kind with the live objects and their memory
+    static void Report(std::ostream& out);
+
+    // Estimated bytes of a texture with the given internal format
+    static size_t TextureBytes(GLenum internalFormat, unsigned int width, unsigned int height, unsigned int depth = 1);
+
+    // Used by GLObject: the GL calls that create and delete each kind
+    static GLuint Create(GLObjectKind kind);
+    static void Destroy(GLObjectKind kind, GLuint id, size_t bytes);
+    static void Resize(GLObjectKind kind, size_t oldBytes, size_t newBytes);
+};
+
+// Owner of one GL object name. The object is created the first time its
+// name is asked for (Get) and deleted with its owner, so it can be a plain
+// member of the classes using it. It can be moved but not copied: there is
+// always exactly one owner deleting each name.
+template <GLObjectKind Kind>
+class GLObject
+{
+public:
+    GLObject() { }
+    ~GLObject() { this->Reset(); }
+
+    GLObject(const GLObject&) = delete;
+    GLObject& operator=(const GLObject&) = delete;
+
+    GLObject(GLObject&& other) noexcept : id(other.id), bytes(other.bytes)
+    {
+        other.id = 0;
+        other.bytes = 0;
+    }
+    GLObject& operator=(GLObject&& other) noexcept
+    {
+        if(this != &other) {
+            this->Reset();
+            this->id = other.id;
+            this->bytes = other.bytes;
+            other.id = 0;
+            other.bytes = 0;
+        }
+        return *this;
+    }
+
+    // GL name of the object, created on the first call
+    GLuint Get()
+    {
+        if(this->id == 0)
+            this->id = GLObjects::Create(Kind);
+        return this->id;
+    }
+    // GL name without creating the object (0 when it does not exist yet)
+    GLuint ID() const { return this->id; }
+
+    // Records the memory held by the object after a (re)allocation of its storage
+    void SetBytes(size_t bytes)
+    {
+        GLObjects::Resize(Kind, this->bytes, bytes);
+        this->bytes = bytes;
+    }
+    size_t Bytes() const { return this->bytes; }
+
+    // Deletes the object, the next Get creates a new one
+    void Reset()
+    {
+        if(this->id == 0) return;
+        GLObjects::Destroy(Kind, this->id, this->bytes);
+        this->id = 0;
+        this->bytes = 0;
+    }
+
+private:
+    GLuint id = 0;
+    size_t bytes = 0;
+};
+
+typedef GLObject<GL_OBJECT_TEXTURE>      GLTexture;
+typedef GLObject<GL_OBJECT_BUFFER>       GLBuffer;
+typedef GLObject<GL_OBJECT_VERTEX_ARRAY> GLVertexArray;
+typedef GLObject<GL_OBJECT_PROGRAM>      GLProgram;
+typedef GLObject<GL_OBJECT_FRAMEBUFFER>  GLFramebuffer;
+
+#endif
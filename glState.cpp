@@ -0,0 +1,143 @@
+#include "glState.h"
+
+
+// Instantiate static variables
+GLCounters GLState::Frame;
+GLCounters GLState::LastFrame;
+// The cache starts with the default state of a new GL context
+GLuint GLState::program = 0;
+GLuint GLState::vertexArray = 0;
+GLenum GLState::activeUnit = GL_TEXTURE0;
+GLuint GLState::textures[GL_STATE_TEXTURE_UNITS][2] = { };
+GLuint GLState::blend = 0;
+GLenum GLState::blendSource = GL_ONE;
+GLenum GLState::blendDestination = GL_ZERO;
+
+
+void GLState::BeginFrame()
+{
+    LastFrame = Frame;
+    Frame = GLCounters();
+}
+
+void GLState::UseProgram(GLuint program)
+{
+    if(GLState::program == program) {
+        Frame.SkippedCalls++;
+        return;
+    }
+    glUseProgram(program);
+    GLState::program = program;
+    Frame.ProgramSwitches++;
+}
+
+void GLState::ActiveTexture(GLenum unit)
+{
+    if(activeUnit == unit) {
+        Frame.SkippedCalls++;
+        return;
+    }
+    glActiveTexture(unit);
+    activeUnit = unit;
+}
+
+void GLState::BindTexture(GLenum target, GLuint texture)
+{
+    // Only the targets used by the engine are tracked, on the first units
+    unsigned int unit = activeUnit == UNKNOWN ? GL_STATE_TEXTURE_UNITS : activeUnit - GL_TEXTURE0;
+    int slot = target == GL_TEXTURE_2D ? 0 : target == GL_TEXTURE_2D_ARRAY ? 1 : -1;
+    if(unit >= GL_STATE_TEXTURE_UNITS || slot < 0) {
+        glBindTexture(target, texture);
+        Frame.TextureBinds++;
+        return;
+    }
+
+    if(textures[unit][slot] == texture) {
+        Frame.SkippedCalls++;
+        return;
+    }
+    glBindTexture(target, texture);
+    textures[unit][slot] = texture;
+    Frame.TextureBinds++;
+}
+
+void GLState::BindVertexArray(GLuint vertexArray)
+{
+    if(GLState::vertexArray == vertexArray) {
+        Frame.SkippedCalls++;
+        return;
+    }
+    glBindVertexArray(vertexArray);
+    GLState::vertexArray = vertexArray;
+    Frame.VertexArrayBinds++;
+}
+
+void GLState::SetBlend(bool enabled)
+{
+    if(blend == static_cast<GLuint>(enabled)) {
+        Frame.SkippedCalls++;
+        return;
+    }
+    if(enabled) glEnable(GL_BLEND);
+    else glDisable(GL_BLEND);
+    blend = enabled;
+}
+
+void GLState::BlendFunc(GLenum source, GLenum destination)
+{
+    if(blendSource == source && blendDestination == destination) {
+        Frame.SkippedCalls++;
+        return;
+    }
+    glBlendFunc(source, destination);
+    blendSource = source;
+    blendDestination = destination;
+}
+
+void GLState::DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    glDrawArrays(mode, first, count);
+    Frame.DrawCalls++;
+}
+
+void GLState::DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+{
+    glDrawArraysInstanced(mode, first, count, instances);
+    Frame.DrawCalls++;
+}
+
+void GLState::DeleteVertexArray(GLuint vertexArray)
+{
+    // GL unbinds a deleted vertex array
+    if(GLState::vertexArray == vertexArray)
+        GLState::vertexArray = 0;
+    glDeleteVertexArrays(1, &vertexArray);
+}
+
+void GLState::DeleteTexture(GLuint texture)
+{
+    // GL binds 0 in place of a deleted texture, and a new texture can get the same name
+    for(auto& unit : textures)
+        for(GLuint& bound : unit)
+            if(bound == texture) bound = 0;
+    glDeleteTextures(1, &texture);
+}
+
+void GLState::DeleteProgram(GLuint program)
+{
+    // A program in use is only deleted when it stops being used, so the next UseProgram must reach GL
+    if(GLState::program == program)
+        GLState::program = UNKNOWN;
+    glDeleteProgram(program);
+}
+
+void GLState::Invalidate()
+{
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    activeUnit = UNKNOWN;
+    for(auto& unit : textures)
+        unit[0] = unit[1] = UNKNOWN;
+    blend = UNKNOWN;
+    blendSource = blendDestination = UNKNOWN;
+}
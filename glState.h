@@ -0,0 +1,72 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include "glad/glad.h"
+
+// Number of texture units tracked by the state cache
+const unsigned int GL_STATE_TEXTURE_UNITS = 8;
+
+// Work submitted to GL during one frame
+struct GLCounters
+{
+    unsigned int DrawCalls = 0;       // glDrawArrays / glDrawArraysInstanced
+    unsigned int ProgramSwitches = 0; // glUseProgram that changed the program
+    unsigned int TextureBinds = 0;    // glBindTexture that changed a binding
+    unsigned int VertexArrayBinds = 0;// glBindVertexArray that changed the VAO
+    unsigned int UniformUploads = 0;  // glUniform* calls
+    unsigned int SkippedCalls = 0;    // calls dropped because the state was already set
+};
+
+// A static state cache in front of the GL calls that change the bound
+// program, textures, vertex array and blending. It remembers what is
+// currently set and skips the calls that would not change anything, so
+// the renderers can state what they need on every draw without paying for
+// it. Every bind of the engine must go through it, otherwise the cache gets
+// out of sync (call Invalidate after touching the state directly).
+class GLState
+{
+public:
+    // Counters of the frame being drawn and of the last complete frame
+    static GLCounters Frame;
+    static GLCounters LastFrame;
+
+    // Closes the counters of the previous frame and starts new ones
+    static void BeginFrame();
+
+    static void UseProgram(GLuint program);
+    static void ActiveTexture(GLenum unit);
+    // Binds a texture on the active unit
+    static void BindTexture(GLenum target, GLuint texture);
+    static void BindVertexArray(GLuint vertexArray);
+    static void SetBlend(bool enabled);
+    static void BlendFunc(GLenum source, GLenum destination);
+
+    // Draws, counted in the frame counters
+    static void DrawArrays(GLenum mode, GLint first, GLsizei count);
+    static void DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances);
+    // Called by the Shader for each uniform it sets
+    static void CountUniform() { Frame.UniformUploads++; }
+
+    // Deletes a vertex array, forgetting it if it was bound
+    static void DeleteVertexArray(GLuint vertexArray);
+    // Deletes a texture, forgetting it on every unit it was bound to
+    static void DeleteTexture(GLuint texture);
+    // Deletes a program, forgetting it if it was in use
+    static void DeleteProgram(GLuint program);
+    // Forgets everything: the next call of each kind always reaches GL
+    static void Invalidate();
+
+private:
+    // Value of a state that is not known yet
+    static const GLuint UNKNOWN = 0xFFFFFFFF;
+
+    static GLuint program;
+    static GLuint vertexArray;
+    static GLenum activeUnit;
+    // Bound textures per unit, for GL_TEXTURE_2D and GL_TEXTURE_2D_ARRAY
+    static GLuint textures[GL_STATE_TEXTURE_UNITS][2];
+    static GLuint blend; // 0, 1 or UNKNOWN
+    static GLenum blendSource, blendDestination;
+};
+
+#endif
@@ -0,0 +1,149 @@
+#include "headlessContext.h"
+
+#include <EGL/eglext.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+
+// glad loads the GL functions through EGL (Mesa returns the core ones too)
+static void* eglLoader(const char* name)
+{
+    return reinterpret_cast<void*>(eglGetProcAddress(name));
+}
+
+
+HeadlessContext::~HeadlessContext()
+{
+    this->Release();
+}
+
+EGLDisplay HeadlessContext::openDisplay()
+{
+    // The surfaceless platform needs no windowing system at all
+    const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if(extensions && std::strstr(extensions, "EGL_MESA_platform_surfaceless") && getPlatformDisplay) {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if(display != EGL_NO_DISPLAY)
+            return display;
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool HeadlessContext::Create(unsigned int width, unsigned int height)
+{
+    this->display = openDisplay();
+    if(this->display == EGL_NO_DISPLAY || !eglInitialize(this->display, nullptr, nullptr)) {
+        std::cerr << "ERROR::HEADLESS: could not open an EGL display" << std::endl;
+        return false;
+    }
+    if(!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "ERROR::HEADLESS: EGL does not support desktop OpenGL" << std::endl;
+        return false;
+    }
+
+    // Any config able to render OpenGL; without one the context is created without a config
+    const EGLint configAttributes[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint configs = 0;
+    eglChooseConfig(this->display, configAttributes, &config, 1, &configs);
+
+    // Same version as the window: 3.3 core
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    this->context = eglCreateContext(this->display, configs > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttributes);
+    if(this->context == EGL_NO_CONTEXT) {
+        std::cerr << "ERROR::HEADLESS: could not create a 3.3 core context (0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        return false;
+    }
+
+    // No surface: the context draws only into framebuffer objects
+    if(!eglMakeCurrent(this->display, EGL_NO_SURFACE, EGL_NO_SURFACE, this->context)) {
+        std::cerr << "ERROR::HEADLESS: the context cannot be made current without a surface" << std::endl;
+        return false;
+    }
+    if(!gladLoadGLLoader((GLADloadproc)eglLoader)) {
+        std::cerr << "ERROR::HEADLESS: failed to initialize GLAD" << std::endl;
+        return false;
+    }
+
+    // The framebuffer takes the place of the window. It is not counted by GLObjects:
+    // it outlives every other object and goes away with the context
+    this->Width = width;
+    this->Height = height;
+    glGenFramebuffers(1, &this->framebuffer);
+    glGenRenderbuffers(1, &this->colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, this->colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindFramebuffer(GL_FRAMEBUFFER, this->framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->colorBuffer);
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR::HEADLESS: the offscreen framebuffer is not complete" << std::endl;
+        return false;
+    }
+    glViewport(0, 0, width, height);
+
+    return true;
+}
+
+void HeadlessContext::Release()
+{
+    if(this->display == EGL_NO_DISPLAY) return;
+
+    if(this->context != EGL_NO_CONTEXT) {
+        if(this->framebuffer) {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glDeleteFramebuffers(1, &this->framebuffer);
+            glDeleteRenderbuffers(1, &this->colorBuffer);
+            this->framebuffer = this->colorBuffer = 0;
+        }
+        eglMakeCurrent(this->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(this->display, this->context);
+        this->context = EGL_NO_CONTEXT;
+    }
+    eglTerminate(this->display);
+    this->display = EGL_NO_DISPLAY;
+}
+
+void HeadlessContext::ReadPixels(std::vector<unsigned char> &pixels) const
+{
+    // GL returns the bottom row first, the images start from the top
+    size_t row = this->Width * 3;
+    std::vector<unsigned char> flipped(row * this->Height);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, this->Width, this->Height, GL_RGB, GL_UNSIGNED_BYTE, flipped.data());
+
+    pixels.resize(flipped.size());
+    for(unsigned int y = 0; y < this->Height; y++)
+        std::memcpy(&pixels[y * row], &flipped[(this->Height - 1 - y) * row], row);
+}
+
+bool HeadlessContext::SavePPM(const std::string &path) const
+{
+    std::vector<unsigned char> pixels;
+    this->ReadPixels(pixels);
+
+    std::ofstream file(path, std::ios::binary);
+    if(!file) {
+        std::cerr << "ERROR::HEADLESS: could not write the image -> " << path << std::endl;
+        return false;
+    }
+    file << "P6\n" << this->Width << " " << this->Height << "\n255\n";
+    file.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+    // A full disk shows up here, not when the file is opened
+    if(!file.flush()) {
+        std::cerr << "ERROR::HEADLESS: could not write the image -> " << path << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+#include "glad/glad.h"
+
+#include <EGL/egl.h>
+
+#include <string>
+#include <vector>
+
+// OpenGL context without a window or a display. It is created through EGL,
+// on Mesa's surfaceless platform when it exists (no X11, no Wayland, no GPU
+// needed: llvmpipe renders on the CPU) or on the default EGL display. The
+// context has no surface of its own, everything is drawn into a framebuffer
+// object of the requested size that stays bound while the context lives.
+class HeadlessContext
+{
+public:
+    // Size of the offscreen framebuffer
+    unsigned int Width, Height;
+
+    HeadlessContext() : Width(0), Height(0) { }
+    ~HeadlessContext();
+
+    // The EGL objects and the framebuffer have a single owner
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // Creates a 3.3 core context, loads the GL functions and binds a width x height framebuffer
+    bool Create(unsigned int width, unsigned int height);
+    // Deletes the framebuffer and the context
+    void Release();
+
+    // Reads the framebuffer as RGB rows, top row first
+    void ReadPixels(std::vector<unsigned char> &pixels) const;
+    // Writes the framebuffer to a binary PPM image, false when the file could not be written
+    bool SavePPM(const std::string &path) const;
+
+private:
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    GLuint framebuffer = 0, colorBuffer = 0;
+
+    // Display of the surfaceless platform, or the default one
+    static EGLDisplay openDisplay();
+};
+
+#endif
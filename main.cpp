@@ -6,8 +6,20 @@
 #include "resourceManager.h"
 #include "textRenderer.h"
 #include "character.h"
-
+#include "glState.h"
+#include "glObject.h"
+#include "headlessContext.h"
+#include "cameraPath.h"
+#include "viewTarget.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <string>
+#include <vector>
 
 // GLFW function declarations
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -18,6 +30,32 @@ void showFPS(float& fpsLastTime, unsigned int& fpsFrameCount);
 
 void showSideMenu();
 
+void showRenderStats();
+
+// Options of the headless runner (--headless), removed from the arguments before the game reads them
+struct HeadlessOptions
+{
+    bool Enabled = false;
+    int Frames = 0;         // 0: one frame, or one per key of the camera path
+    std::string CameraFile; // Camera path, the player stays at its start without one
+    std::string Output;     // Image of the last frame, or of every frame when the name has a %d
+    // Output split around its %d (or %0Nd), which becomes the frame number
+    bool EveryFrame = false;
+    std::string OutputPrefix, OutputSuffix;
+    unsigned int OutputDigits = 0; // Zero padding of the frame number
+};
+bool takeHeadlessOptions(std::vector<char*>& args, HeadlessOptions& options);
+// Name of the image of a frame when every frame is written
+std::string frameFileName(const HeadlessOptions& options, int frame);
+
+// Renders the level offscreen, without a window or a display
+int runHeadless(int argc, char* argv[], const HeadlessOptions& options);
+
+// GL state shared by the window and the headless runner
+void configureGL();
+// Deletes the GL objects while the context still exists and reports the leaks
+void releaseResources();
+
 // The Width of the screen
 const unsigned int SCREEN_WIDTH = 1024;
 // The height of the screen
@@ -33,6 +71,17 @@ TextRenderer *textRenderer;
 
 int main(int argc, char *argv[])
 {
+    // The headless options are taken out, the game gets the rest
+    std::vector<char*> args(argv, argv + argc);
+    HeadlessOptions headless;
+    if(!takeHeadlessOptions(args, headless))
+        return 1;
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
+    if(headless.Enabled)
+        return runHeadless(argc, argv, headless);
+
     // Starts glfw and defines the version that will be used
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -57,17 +106,20 @@ int main(int argc, char *argv[])
 
     // OpenGL configuration
     // --------------------
-    glEnable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    configureGL();
 
     // initialize game
     // ---------------
     Engine.Init(argc, argv);
+
+    // The framebuffer can be bigger than the window (high DPI screens)
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    Engine.Resize(framebufferWidth, framebufferHeight);
     
 
     // Create the text shader
-    Shader TextShader = ResourceManager::GetShader("text");
+    Shader& TextShader = ResourceManager::GetShader(ResourceManager::FindShader("text"));
 
     // Instansiate the Text Renderer
     textRenderer = new TextRenderer(TextShader);
@@ -75,6 +127,10 @@ int main(int argc, char *argv[])
     // Load the character font
     textRenderer->LoadFont("Fonts/Antonio-Bold.ttf", 48);
 
+    // What the level load left on the GPU
+    std::cout << "GL objects after loading:" << std::endl;
+    GLObjects::Report(std::cout);
+
     // deltaTime variables
     // -------------------
     float deltaTime = 0.0f;
@@ -94,6 +150,9 @@ int main(int argc, char *argv[])
         lastFrame = currentFrame;
 
         
+        // Start counting the GL work of the new frame
+        GLState::BeginFrame();
+
         glfwPollEvents();
         
         // manage user input
@@ -115,23 +174,196 @@ int main(int argc, char *argv[])
         showFPS(fpsLastTime, fpsFrameCount);
         // Render side Menu
         showSideMenu();
+        // Render the GL counters of the last frame
+        showRenderStats();
         
         glfwSwapBuffers(window);
     }
 
     // delete all resources as loaded using the resource manager
     // ---------------------------------------------------------
-    ResourceManager::Clear();
+    delete textRenderer;
+    releaseResources();
 
     glfwTerminate();
     return 0;
 }
 
+bool takeHeadlessOptions(std::vector<char*>& args, HeadlessOptions& options)
+{
+    std::vector<char*> rest;
+    for(size_t i = 0; i < args.size(); i++) {
+        std::string option = args[i];
+        bool hasValue = i + 1 < args.size();
+
+        if(option == "--headless") {
+            options.Enabled = true;
+        }
+        else if(option == "--frames" && hasValue) {
+            options.Frames = std::atoi(args[++i]);
+            if(options.Frames <= 0) {
+                std::cerr << "Error: the frame count must be positive -> " << args[i] << std::endl;
+                return false;
+            }
+        }
+        else if(option == "--camera" && hasValue) {
+            options.CameraFile = args[++i];
+        }
+        else if(option == "--output" && hasValue) {
+            options.Output = args[++i];
+        }
+        else {
+            rest.push_back(args[i]);
+        }
+    }
+
+    if(!options.Enabled && (options.Frames > 0 || !options.CameraFile.empty() || !options.Output.empty())) {
+        std::cerr << "Error: --frames, --camera and --output need --headless" << std::endl;
+        return false;
+    }
+
+    // The output name is never used as a format string: its only % must be a %d or %0Nd,
+    // which is replaced by the frame number
+    size_t percent = options.Output.find('%');
+    if(percent != std::string::npos) {
+        const std::string& name = options.Output;
+        size_t end = percent + 1;
+        bool padded = end < name.size() && name[end] == '0';
+        size_t digits = padded ? end + 1 : end;
+        end = digits;
+        while(end < name.size() && end - digits < 2 && std::isdigit(static_cast<unsigned char>(name[end]))) end++;
+
+        if(end >= name.size() || name[end] != 'd' || (padded && end == digits) || (!padded && end != digits) ||
+           name.find('%', end + 1) != std::string::npos) {
+            std::cerr << "Error: the output name can only have one %d or %0<width>d -> " << name << std::endl;
+            return false;
+        }
+
+        options.EveryFrame = true;
+        options.OutputPrefix = name.substr(0, percent);
+        options.OutputSuffix = name.substr(end + 1);
+        options.OutputDigits = padded ? static_cast<unsigned int>(std::stoi(name.substr(digits, end - digits))) : 0;
+    }
+
+    args = rest;
+    return true;
+}
+
+std::string frameFileName(const HeadlessOptions& options, int frame)
+{
+    std::string number = std::to_string(frame);
+    if(number.size() < options.OutputDigits)
+        number.insert(0, options.OutputDigits - number.size(), '0');
+    return options.OutputPrefix + number + options.OutputSuffix;
+}
+
+int runHeadless(int argc, char* argv[], const HeadlessOptions& options)
+{
+    // Offscreen context with a framebuffer the size of the window
+    HeadlessContext context;
+    if(!context.Create(SCREEN_WIDTH, SCREEN_HEIGHT))
+        return -1;
+    std::cout << "Headless renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+    configureGL();
+    Engine.Init(argc, argv);
+    Engine.Resize(SCREEN_WIDTH, SCREEN_HEIGHT);
+
+    CameraPath path;
+    if(!options.CameraFile.empty() && !path.Load(options.CameraFile)) {
+        releaseResources();
+        return 1;
+    }
+
+    std::cout << "GL objects after loading:" << std::endl;
+    GLObjects::Report(std::cout);
+
+    int frames = options.Frames > 0 ? options.Frames : (path.Keys.empty() ? 1 : static_cast<int>(path.Keys.size()));
+
+    // Fixed time step, so two runs render the same frames
+    const float deltaTime = 1.0f / 60.0f;
+    double totalTime = 0.0, minTime = 1e9, maxTime = 0.0;
+    // A missing image fails the run, so the scripts comparing them notice
+    bool imagesSaved = true;
+
+    for(int frame = 0; frame < frames; frame++) {
+        if(!path.Keys.empty()) {
+            CameraKey camera = path.Sample(frames > 1 ? static_cast<float>(frame) / (frames - 1) : 0.0f);
+            Engine.SetCamera(camera.Position, camera.Angle);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        GLState::BeginFrame();
+        Engine.Update(deltaTime);
+        glClearColor(0.25f, 0.25f, 0.25f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        Engine.Render();
+        // The frame time includes the GPU work
+        glFinish();
+
+        double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        totalTime += time;
+        minTime = std::min(minTime, time);
+        maxTime = std::max(maxTime, time);
+
+        if(options.EveryFrame && !context.SavePPM(frameFileName(options, frame)))
+            imagesSaved = false;
+    }
+
+    if(!options.Output.empty() && !options.EveryFrame && !context.SavePPM(options.Output))
+        imagesSaved = false;
+
+    // Summary for the benchmarks and the regression runs
+    const GLCounters& stats = GLState::Frame;
+    std::printf("Frames: %d  average: %.3f ms  min: %.3f ms  max: %.3f ms\n", frames, totalTime / frames, minTime, maxTime);
+    std::printf("3D view: %dx%d of %dx%d\n", Engine.View().Internal.x, Engine.View().Internal.y, Engine.View().Native.x, Engine.View().Native.y);
+    std::printf("Last frame: %u draw calls, %u program switches, %u texture binds, %u VAO binds, %u uniform uploads, %u skipped calls\n",
+                stats.DrawCalls, stats.ProgramSwitches, stats.TextureBinds, stats.VertexArrayBinds, stats.UniformUploads, stats.SkippedCalls);
+
+    GLenum error = glGetError();
+    if(error != GL_NO_ERROR)
+        std::cerr << "ERROR::HEADLESS: GL error 0x" << std::hex << error << std::dec << std::endl;
+
+    releaseResources();
+    context.Release();
+    return (error == GL_NO_ERROR && imagesSaved) ? 0 : 1;
+}
+
+void configureGL()
+{
+    glEnable(GL_CULL_FACE);
+    GLState::SetBlend(true);
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void releaseResources()
+{
+    Engine.Release();
+    ResourceManager::Clear();
+
+    // Every GL object must be gone by now, anything left is a leak
+    if(GLObjects::TotalLive() > 0) {
+        std::cerr << "WARNING: GL objects still alive at exit:" << std::endl;
+        GLObjects::Report(std::cerr);
+    }
+}
+
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
 {
     // when a user presses the escape key, we set the WindowShouldClose property to true, closing the application
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
+    // F1 shows/hides the GL counters
+    if (key == GLFW_KEY_F1 && action == GLFW_PRESS)
+        Engine.renderStatsOn = !Engine.renderStatsOn;
+    // F2 / F3 lower / raise the resolution of the 3D view, F4 switches how it is upscaled
+    if (key == GLFW_KEY_F2 && action == GLFW_PRESS)
+        Engine.ChangeViewScale(-VIEW_SCALE_STEP);
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS)
+        Engine.ChangeViewScale(VIEW_SCALE_STEP);
+    if (key == GLFW_KEY_F4 && action == GLFW_PRESS)
+        Engine.SwitchUpscaleFilter();
     if (key >= 0 && key < 1024)
     {
         if (action == GLFW_PRESS)
@@ -146,6 +378,7 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
     // make sure the viewport matches the new window dimensions; note that width and 
     // height will be significantly larger than specified on retina displays.
     glViewport(0, 0, width, height);
+    Engine.Resize(width, height);
 }
 
 
@@ -165,8 +398,8 @@ void showFPS(float& fpsLastTime, unsigned int& fpsFrameCount) {
         fpsFrameCount = 0;
         fpsLastTime = currentTime;
     }
-    // Show the FPS time on screen
-    textRenderer->DrawText("FPS: " + std::to_string(static_cast<int>(FPS)),
+    // Show the FPS time on screen (it changes too often to be worth caching)
+    textRenderer->DrawDynamicText("FPS: " + std::to_string(static_cast<int>(FPS)),
         0.0f, 480.0f, 0.5f, glm::vec3(1.0, 0.0f, 0.0f));
 
 }
@@ -189,5 +422,36 @@ void showSideMenu() {
             0.0f, 375.0f, 0.5f, glm::vec3(0.5, 0.8f, 0.2f));
         textRenderer->DrawText("Shift: Sprint",
             0.0f, 350.0f, 0.5f, glm::vec3(0.5, 0.8f, 0.2f));
+        textRenderer->DrawText("F1: Render stats",
+            0.0f, 325.0f, 0.5f, glm::vec3(0.5, 0.8f, 0.2f));
+        textRenderer->DrawText("F2 / F3: Lower / raise resolution",
+            0.0f, 300.0f, 0.5f, glm::vec3(0.5, 0.8f, 0.2f));
+        textRenderer->DrawText("F4: Nearest / sharp upscale",
+            0.0f, 275.0f, 0.5f, glm::vec3(0.5, 0.8f, 0.2f));
     }
-}
\ No newline at end of file
+}
+
+void showRenderStats() {
+
+    if(!Engine.renderStatsOn) return;
+
+    // Counters of the last complete frame (the current one is still being drawn)
+    const GLCounters& stats = GLState::LastFrame;
+    float x = SCREEN_WIDTH/2 + 10.0f;
+    glm::vec3 color(1.0f, 1.0f, 0.2f);
+
+    textRenderer->DrawDynamicText("Draw calls: " + std::to_string(stats.DrawCalls), x, 480.0f, 0.4f, color);
+    textRenderer->DrawDynamicText("Program switches: " + std::to_string(stats.ProgramSwitches), x, 460.0f, 0.4f, color);
+    textRenderer->DrawDynamicText("Texture binds: " + std::to_string(stats.TextureBinds), x, 440.0f, 0.4f, color);
+    textRenderer->DrawDynamicText("VAO binds: " + std::to_string(stats.VertexArrayBinds), x, 420.0f, 0.4f, color);
+    textRenderer->DrawDynamicText("Uniform uploads: " + std::to_string(stats.UniformUploads), x, 400.0f, 0.4f, color);
+    textRenderer->DrawDynamicText("Skipped calls: " + std::to_string(stats.SkippedCalls), x, 380.0f, 0.4f, color);
+    // Objects alive on the GPU right now
+    textRenderer->DrawDynamicText("GL objects: " + std::to_string(GLObjects::TotalLive()) + " (" +
+        std::to_string(GLObjects::TotalBytes() / 1024) + " KiB)", x, 360.0f, 0.4f, color);
+    // Resolution the 3D view is drawn at
+    const ViewTarget& view = Engine.View();
+    textRenderer->DrawText("3D view: " + std::to_string(view.Internal.x) + "x" + std::to_string(view.Internal.y) + " (" +
+        std::to_string(static_cast<int>(view.Scale * 100.0f + 0.5f)) + "%, " +
+        (view.Filter == UPSCALE_NEAREST ? "nearest" : "sharp") + ")", x, 340.0f, 0.4f, color);
+}
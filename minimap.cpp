@@ -0,0 +1,142 @@
+#include "minimap.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+
+Minimap::Minimap(SpriteRenderer &renderer, FrameUniforms &frame, glm::vec2 panelSize)
+    : PanelSize(panelSize), CellSize(0.0f), Origin(0.0f), renderer(renderer), frame(frame),
+      mapSize(0), levelCell(0.0f), image(GL_RGBA, GL_RGBA, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_NEAREST, GL_NEAREST),
+      firstCell(0), cells(0)
+{
+
+}
+
+void Minimap::setLevel(const GameLevel &level)
+{
+    this->level = &level;
+    this->levelGeneration = level.Generation;
+    this->mapSize = glm::ivec2(level.tileData[0].size(), level.tileData.size());
+
+    // The level places its objects with cells that fill the panel
+    this->levelCell = this->PanelSize / glm::vec2(this->mapSize);
+
+    // Each axis keeps the fitted size unless the cells get too small, then it scrolls
+    this->CellSize = glm::max(this->levelCell, glm::vec2(MINIMAP_MIN_CELL));
+
+    // Cells kept in the texture: the whole map, or the visible ones plus one for the scrolling
+    glm::vec2 visible = this->PanelSize / this->CellSize;
+    for(int axis = 0; axis < 2; axis++) {
+        if(this->CellSize[axis] == this->levelCell[axis])
+            this->cells[axis] = this->mapSize[axis];
+        else
+            this->cells[axis] = std::min(this->mapSize[axis], static_cast<int>(std::ceil(visible[axis])) + 1);
+    }
+
+    // The texture covers the window at the panel resolution
+    unsigned int width = static_cast<unsigned int>(std::ceil(this->cells.x * this->CellSize.x));
+    unsigned int height = static_cast<unsigned int>(std::ceil(this->cells.y * this->CellSize.y));
+    if(width != this->image.Width || height != this->image.Height) {
+        this->image.Generate(width, height, nullptr);
+
+        GLint previousFramebuffer;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, this->framebuffer.Get());
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->image.ID(), 0);
+        if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "ERROR::MINIMAP: the offscreen framebuffer is not complete" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    }
+
+    this->firstCell = glm::ivec2(-1);
+    this->dirty = true;
+}
+
+void Minimap::Update(const GameLevel &level, glm::vec2 playerPosition)
+{
+    // A reload keeps the same GameLevel, so the generation tells that the map changed
+    if(&level != this->level || level.Generation != this->levelGeneration)
+        this->setLevel(level);
+
+    // Window centred on the player, stopped at the borders of the map
+    glm::vec2 visible = this->PanelSize / this->CellSize;
+    glm::vec2 playerCell = playerPosition / level.tileSize;
+    glm::vec2 last = glm::max(glm::vec2(this->mapSize) - visible, glm::vec2(0.0f));
+    this->Origin = glm::clamp(playerCell - visible * 0.5f, glm::vec2(0.0f), last);
+
+    // The texture only has to move when the first cell changes
+    glm::ivec2 first = glm::min(glm::ivec2(glm::floor(this->Origin)), this->mapSize - this->cells);
+    if(first != this->firstCell) {
+        this->firstCell = first;
+        this->dirty = true;
+    }
+
+    if(this->dirty)
+        this->build();
+}
+
+void Minimap::build()
+{
+    // Everything changed here is put back afterwards (the caller may be drawing into its own framebuffer)
+    GLint previousFramebuffer, viewport[4];
+    GLfloat clearColor[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+    glm::mat4 screenProjection = this->frame.Data.Projection;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->framebuffer.ID());
+    glViewport(0, 0, this->image.Width, this->image.Height);
+    // The empty cells stay transparent, so the panel shows the screen background through them
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // Same orientation as the screen projection (so the culled faces are the same): the top of the window
+    // ends up in the last row of the texture
+    this->frame.SetProjection(glm::ortho(0.0f, static_cast<float>(this->image.Width), static_cast<float>(this->image.Height), 0.0f, -1.0f, 1.0f));
+
+    // Only the walls of the window are drawn, they never overlap so they are batched
+    this->renderer.Begin();
+    for(int y = this->firstCell.y; y < this->firstCell.y + this->cells.y; y++) {
+        for(int x = this->firstCell.x; x < this->firstCell.x + this->cells.x; x++) {
+            if(this->level->tileData[y][x] == 0) continue;
+
+            const GameObject &tile = this->level->tileInfo[y][x];
+            glm::vec2 position = glm::vec2(x - this->firstCell.x, y - this->firstCell.y) * this->CellSize;
+            this->renderer.DrawSprite(tile.Sprite, position, this->CellSize, 0.0f, tile.Color);
+        }
+    }
+    this->renderer.End();
+
+    this->frame.SetProjection(screenProjection);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+
+    this->dirty = false;
+    this->Builds++;
+}
+
+void Minimap::Draw()
+{
+    // The part of the texture under the panel, in texture coordinates (v goes up from the bottom row)
+    glm::vec2 imageSize(this->image.Width, this->image.Height);
+    glm::vec2 offset = (this->Origin - glm::vec2(this->firstCell)) * this->CellSize;
+    glm::vec2 first = offset / imageSize, last = (offset + this->PanelSize) / imageSize;
+    glm::vec4 uv(first.x, 1.0f - first.y, last.x, 1.0f - last.y);
+
+    this->renderer.DrawSprite(TextureHandle(this->image), glm::vec2(0.0f), this->PanelSize, 0.0f, glm::vec3(1.0f), glm::vec2(0.5f), uv);
+}
+
+void Minimap::DrawMarker(SpriteRenderer &renderer, const GameObject &marker)
+{
+    // World pixels -> map cells -> panel pixels
+    glm::vec2 cell = marker.Position / this->level->tileSize;
+    glm::vec2 position = (cell - this->Origin) * this->CellSize;
+    glm::vec2 size = marker.Size * this->CellSize / this->levelCell;
+
+    renderer.DrawSprite(marker.Sprite, position, size, marker.Rotation, marker.Color, marker.Pivot);
+}
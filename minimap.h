@@ -0,0 +1,69 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "gameLevel.h"
+#include "gameObject.h"
+#include "spriteRenderer.h"
+#include "frameUniforms.h"
+#include "texture.h"
+#include "glObject.h"
+
+// Smallest size of a map cell on the minimap, in pixels. Maps whose cells
+// would be smaller on the panel are shown through a window that follows
+// the player instead of being squeezed into it.
+const float MINIMAP_MIN_CELL = 4.0f;
+
+// The level map drawn on the left panel. The walls never change, so they
+// are drawn once into an offscreen texture and the panel only draws that
+// texture plus the player marker on each frame. When the whole map fits,
+// the texture holds the whole map and is built once per level. Otherwise
+// it holds the cells around the player (one more than the panel shows on
+// each axis) and it is built again only when that window moves by a cell;
+// in between the panel scrolls smoothly inside the texture.
+class Minimap
+{
+public:
+    // Size of the panel on the screen (its top-left corner is the screen origin)
+    glm::vec2 PanelSize;
+    // Size of a map cell on the panel
+    glm::vec2 CellSize;
+    // Map cell at the top-left corner of the panel (fractional while scrolling)
+    glm::vec2 Origin;
+    // Times the offscreen texture was drawn
+    unsigned int Builds = 0;
+
+    // The tiles and the panel are drawn with renderer; frame holds the projection swapped while building
+    Minimap(SpriteRenderer &renderer, FrameUniforms &frame, glm::vec2 panelSize);
+
+    // Follows the player (position in world pixels), building the texture again when the level (or its generation) or the window changed
+    void Update(const GameLevel &level, glm::vec2 playerPosition);
+    // Draws the visible part of the map on the panel
+    void Draw();
+    // Draws an object of the level (the player marker) at its place on the panel
+    void DrawMarker(SpriteRenderer &renderer, const GameObject &marker);
+
+private:
+    SpriteRenderer &renderer;
+    FrameUniforms  &frame;
+
+    const GameLevel *level = nullptr;
+    unsigned int levelGeneration = 0; // Generation of the level the texture was built from
+    glm::ivec2 mapSize;     // Cells of the level
+    glm::vec2  levelCell;   // Size of the cells the level objects were placed with
+
+    // Offscreen copy of the cells [firstCell, firstCell + cells)
+    Texture2D     image;
+    GLFramebuffer framebuffer;
+    glm::ivec2    firstCell, cells;
+    bool          dirty = true;
+
+    // Prepares the window and the texture for a new level
+    void setLevel(const GameLevel &level);
+    // Draws the cells of the window into the texture
+    void build();
+};
+
+#endif
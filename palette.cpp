@@ -0,0 +1,130 @@
+#include "palette.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+// Number of 15-bit colors
+const unsigned int PALETTE_COLOR_SPACE = 1 << 15;
+
+// Channel (0 red, 1 green, 2 blue) of a 15-bit color, in 5 bits
+static inline unsigned int channel15(unsigned int color, int channel)
+{
+    return (color >> (10 - 5 * channel)) & 31;
+}
+
+// A box of the median cut: a range of the color list
+struct PaletteBox
+{
+    unsigned int First, Count; // Colors [First, First + Count) of the list
+    unsigned int Axis;         // Channel with the widest range
+    unsigned int Range;        // Width of that range
+};
+
+
+void Palette::Build(const unsigned char* rgba, size_t count)
+{
+    // Histogram of the 15-bit colors
+    std::vector<unsigned int> histogram(PALETTE_COLOR_SPACE, 0);
+    for(size_t i = 0; i < count; i++) {
+        const unsigned char* texel = rgba + i * 4;
+        histogram[((texel[0] >> 3) << 10) | ((texel[1] >> 3) << 5) | (texel[2] >> 3)]++;
+    }
+
+    // The colors used, which the boxes split in ranges
+    std::vector<unsigned int> colors;
+    for(unsigned int color = 0; color < PALETTE_COLOR_SPACE; color++)
+        if(histogram[color] > 0) colors.push_back(color);
+
+    auto measure = [&](PaletteBox& box) {
+        box.Range = 0;
+        for(int axis = 0; axis < 3; axis++) {
+            unsigned int low = 31, high = 0;
+            for(unsigned int i = box.First; i < box.First + box.Count; i++) {
+                low = std::min(low, channel15(colors[i], axis));
+                high = std::max(high, channel15(colors[i], axis));
+            }
+            if(high - low >= box.Range) {
+                box.Range = high - low;
+                box.Axis = axis;
+            }
+        }
+    };
+
+    // Median cut: the box with the widest range is split at the median of its texels,
+    // until every index but the black one has a box
+    std::vector<PaletteBox> boxes;
+    if(!colors.empty()) {
+        boxes.push_back({0, static_cast<unsigned int>(colors.size()), 0, 0});
+        measure(boxes[0]);
+    }
+    while(boxes.size() < PALETTE_COLORS - 1) {
+        auto widest = std::max_element(boxes.begin(), boxes.end(), [](const PaletteBox& a, const PaletteBox& b) {
+            return a.Range < b.Range;
+        });
+        if(widest == boxes.end() || widest->Count < 2 || widest->Range == 0) break;
+
+        PaletteBox box = *widest;
+        std::sort(colors.begin() + box.First, colors.begin() + box.First + box.Count, [&](unsigned int a, unsigned int b) {
+            return channel15(a, box.Axis) < channel15(b, box.Axis);
+        });
+
+        // Half of the texels (not of the colors) on each side
+        unsigned long long total = 0, half = 0;
+        for(unsigned int i = box.First; i < box.First + box.Count; i++) total += histogram[colors[i]];
+        unsigned int split = box.First;
+        while(split < box.First + box.Count - 1 && half + histogram[colors[split]] <= total / 2)
+            half += histogram[colors[split++]];
+        split = std::max(split, box.First + 1);
+
+        PaletteBox low = {box.First, split - box.First, 0, 0};
+        PaletteBox high = {split, box.First + box.Count - split, 0, 0};
+        measure(low);
+        measure(high);
+        *widest = low;
+        boxes.push_back(high);
+    }
+
+    // Each box becomes the average of its texels, the unused entries stay black
+    // Index 0 is pure black: the sprites treat it as transparent and the empty pixels use it
+    std::memset(this->Colors, 0, sizeof(this->Colors));
+    for(size_t b = 0; b < boxes.size(); b++) {
+        unsigned long long sum[3] = {0, 0, 0}, weight = 0;
+        for(unsigned int i = boxes[b].First; i < boxes[b].First + boxes[b].Count; i++) {
+            unsigned int color = colors[i];
+            for(int axis = 0; axis < 3; axis++)
+                sum[axis] += static_cast<unsigned long long>(channel15(color, axis) * 8 + 4) * histogram[color];
+            weight += histogram[color];
+        }
+        for(int axis = 0; axis < 3; axis++)
+            this->Colors[PALETTE_BLACK + 1 + b][axis] = static_cast<unsigned char>(sum[axis] / weight);
+    }
+
+    // Inverse table: nearest palette color of every 15-bit color
+    this->inverse.assign(PALETTE_COLOR_SPACE, 0);
+    for(unsigned int color = 0; color < PALETTE_COLOR_SPACE; color++) {
+        int r = channel15(color, 0) * 8 + 4, g = channel15(color, 1) * 8 + 4, b = channel15(color, 2) * 8 + 4;
+        if(color == 0) r = g = b = 0; // Exactly black
+
+        int best = 0, bestDistance = 1 << 30;
+        for(unsigned int i = 0; i < PALETTE_COLORS; i++) {
+            int dr = r - this->Colors[i][0], dg = g - this->Colors[i][1], db = b - this->Colors[i][2];
+            int distance = dr * dr + dg * dg + db * db;
+            if(distance < bestDistance) {
+                bestDistance = distance;
+                best = i;
+            }
+        }
+        this->inverse[color] = static_cast<unsigned char>(best);
+    }
+
+    // Color map: every index darkened to each level
+    for(unsigned int level = 0; level < PALETTE_SHADES; level++) {
+        unsigned int brightness = PALETTE_SHADES - level;
+        for(unsigned int i = 0; i < PALETTE_COLORS; i++) {
+            this->ColorMap[level][i] = this->Nearest(this->Colors[i][0] * brightness / PALETTE_SHADES,
+                                                     this->Colors[i][1] * brightness / PALETTE_SHADES,
+                                                     this->Colors[i][2] * brightness / PALETTE_SHADES);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include <cstddef>
+#include <vector>
+
+// Colors of the shared palette
+const unsigned int PALETTE_COLORS = 256;
+// Index of pure black, always present
+const unsigned int PALETTE_BLACK = 0;
+// Brightness levels of the color map: level l shows the colors at (PALETTE_SHADES - l) / PALETTE_SHADES
+const unsigned int PALETTE_SHADES = 32;
+// Level of the half brightness used by the shaded walls, the floor and the ceiling
+const unsigned int PALETTE_HALF_SHADE = PALETTE_SHADES / 2;
+
+// 256 color palette shared by every texture, for the indexed pipeline.
+// It is built once from the texels of the loaded textures (median cut over
+// their 15-bit colors), and comes with two tables computed at the same time:
+// an inverse table that turns any 15-bit color into its nearest palette
+// index, and a color map with the index of every color at each brightness
+// level. Shading an indexed pixel is then one table lookup, like the color
+// maps of the classic engines, instead of three multiplications.
+class Palette
+{
+public:
+    // RGB of each index
+    unsigned char Colors[PALETTE_COLORS][3];
+    // ColorMap[level][index]: the color of index darkened to the brightness of level
+    unsigned char ColorMap[PALETTE_SHADES][PALETTE_COLORS];
+
+    Palette() { }
+
+    // Builds the palette from count RGBA texels (the alpha is ignored)
+    void Build(const unsigned char* rgba, size_t count);
+
+    // Index of the palette color nearest to (r, g, b)
+    unsigned char Nearest(unsigned char r, unsigned char g, unsigned char b) const
+    {
+        return this->inverse[((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3)];
+    }
+
+    // True once Build was called
+    bool Ready() const { return !this->inverse.empty(); }
+
+private:
+    // Nearest index of each 15-bit color (5 bits per channel)
+    std::vector<unsigned char> inverse;
+};
+
+#endif
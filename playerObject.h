@@ -20,7 +20,7 @@ class PlayerObject : public GameObject {
     // Constructor
     PlayerObject();
 
-    PlayerObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color, float velocity, float rotSpeed, glm::vec2 direction, glm::vec2 plane, float hitbox);
+    PlayerObject(glm::vec2 pos, glm::vec2 size, TextureHandle sprite, glm::vec3 color, float velocity, float rotSpeed, glm::vec2 direction, glm::vec2 plane, float hitbox);
 
 
 };
@@ -1,5 +1,15 @@
 #include "rayCasting.h"
+#include "floorProjection.h"
 #include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+// How many times the sky texture repeats around the player (360 degrees)
+const float SKY_REPEATS = 4.0f;
+// Gathered count of a cluster whose impostor is already in the sprite list of the frame
+const unsigned int CLUSTER_LISTED = UINT_MAX;
 
 
 RayCasting::RayCasting(
@@ -10,16 +20,16 @@ RayCasting::RayCasting(
     GameLevel* level,
     SpriteRenderer* wallRenderer,
     SpriteRenderer* floorRenderer,
-    SpriteRenderer* spriteRenderer,
-    GameObject* wallObj,
+    SpriteInstanceRenderer* spriteRenderer,
+    SpriteRenderer* skyRenderer,
     GameObject* floorObj,
-    GameObject* spriteObj,
+    GameObject* skyObj,
     Texture2D* floorTexture
 )
 : Width(screenWidth), Height(screenHeight), rayDensity(rayDensity),
   Player(player), Level(level),
-  WallRenderer(wallRenderer), FloorRenderer(floorRenderer), SpRenderer(spriteRenderer),
-  wallObj(wallObj), floorObj(floorObj), spriteObj(spriteObj), floorTexture(floorTexture)
+  WallRenderer(wallRenderer), FloorRenderer(floorRenderer), SpRenderer(spriteRenderer), SkyRenderer(skyRenderer),
+  floorObj(floorObj), skyObj(skyObj), floorTexture(floorTexture)
 {
     
     // Define the level scale based on the map size
@@ -29,126 +39,225 @@ RayCasting::RayCasting(
 
     // Resize the spriteDistance based on the numbers of sprites avaiable
     numSprites = Level->elementsInfo.size();
-    spriteDistance.resize(numSprites);
-    spriteOrder.resize(numSprites);
+    spriteDistance.reserve(numSprites);
+    spriteOrder.reserve(numSprites);
+    spriteInstances.reserve(numSprites);
+    spriteSorter.Reserve(numSprites);
+
+    // Projection: screenX = Width/4 * (1 + planeX/depth), sprite width = Height/depth
+    spritePlaneWidth = 4.0f * Height / Width;
+
+    // The sprites never move, their positions and textures are copied once into flat arrays
+    spriteX.resize(numSprites);
+    spriteY.resize(numSprites);
+    spriteLayer.resize(numSprites);
+    for(unsigned int i = 0; i < numSprites; i++) {
+        spriteX[i] = Level->elementsInfo[i].Position.x / mapScale;
+        spriteY[i] = Level->elementsInfo[i].Position.y / mapScale;
+        spriteLayer[i] = Level->elementsInfo[i].Sprite->Layer;
+    }
+    projectionSlot.resize(numSprites);
+    projection.Resize(numSprites);
+
+    // One depth texel per ray column
+    depthTexture.Generate(Width/2);
+
+    // The sky uniforms change every frame, their locations are looked up once
+    skyShader = &ResourceManager::GetShader(ResourceManager::FindShader("sky"));
+    skyOffsetLocation = skyShader->Location("skyOffset");
+    skySpanLocation = skyShader->Location("skySpan");
+
+    // One stamp per map cell
+    visitedStamp.assign(mapSizeGridX * mapSizeGridY, 0);
+    gatheredStamp.assign(mapSizeGridX * mapSizeGridY, 0);
+}
+
+void RayCasting::EnableCpuSprites(SpriteRasterizer* rasterizer, SpriteRenderer* layerRenderer, GameObject* layerObj, Texture2D* layerTexture) {
+    spriteRasterizer = rasterizer;
+    spriteLayerRenderer = layerRenderer;
+    spriteLayerObj = layerObj;
+    spriteLayerTexture = layerTexture;
+}
+
+void RayCasting::EnableSoftwareRenderer(SoftwareRenderer* software, SpriteRasterizer* rasterizer, SpriteRenderer* presentRenderer) {
+    softwareRenderer = software;
+    spriteRasterizer = rasterizer;
+    softwarePresenter = presentRenderer;
+}
+
+void RayCasting::EnableImpostors() {
+    spriteClusters.Build(Level->elementsInfo, mapScale);
+    clusterStamp.assign(spriteClusters.Clusters.size(), 0);
+    clusterGathered.assign(spriteClusters.Clusters.size(), 0);
+    useImpostors = true;
+
+    // The impostors are sorted together with the sprites
+    spriteSorter.Reserve(numSprites + spriteClusters.Clusters.size());
+    projectionSlot.resize(numSprites + spriteClusters.Clusters.size());
 }
 
 // ===================== WALL CASTING ALGORRITHM =====================
 
-void RayCasting::WallCasting(std::vector<float>& zBuffer) {
- 
-    // Set a variable to store the texture
-    Texture2D currentTexture;
-    // Each interation creates a ray which are distributed throught the plane(screen) space;
-    // Our screen is split in half
-    for(int x = 0; x < Width/2; x+= rayDensity) {
-        // calculate ray position and direction
-        
-        /*
-        cameraX is the x-coordinate on the camera plane that the current x-coordinate of the screen represents, 
-        done this way so that the right side of the screen will get coordinate 1, the center of the screen gets coordinate 0, 
-        and the left side of the screen gets coordinate -1.
-        */
-
-        float cameraX = 2 * x / static_cast<float>(Width/2) - 1; //gets the x-coordinate of the ray in the
-        glm::vec2 rayDir = glm::vec2(Player->direction.x + Player->plane.x * cameraX, Player->direction.y + Player->plane.y * cameraX);
-        
-        // The amount of units to the ray hit the next tile
-        glm::vec2 deltaDist = glm::vec2(std::abs(1/rayDir.x), std::abs(1/rayDir.y));
-
-
-        //Which box of the map we're in
-        int mapx = ((static_cast<int>(Player->Position.x/mapScale)));
-        int mapy = ((static_cast<int>(Player->Position.y/mapScale)));
-       
-        //length of ray from current position to next x or y-side
-        float sideDistX;
-        float sideDistY;
-
-        /*
-        length of ray from one x or y-side to next x or y-side
-        these are derived as:
-        deltaDistX = sqrt(1 + (rayDirY * rayDirY) / (rayDirX * rayDirX))
-        deltaDistY = sqrt(1 + (rayDirX * rayDirX) / (rayDirY * rayDirY))
-        which can be simplified to abs(|rayDir| / rayDirX) and abs(|rayDir| / rayDirY)
-        where |rayDir| is the length of the vector (rayDirX, rayDirY). Its length,
-        unlike (dirX, dirY) is not 1, however this does not matter, only the
-        ratio between deltaDistX and deltaDistY matters, due to the way the DDA
-        stepping further below works
-        */
-        float deltaDistX = std::abs(1/rayDir.x);
-        float deltaDistY = std::abs(1/rayDir.y);
-
-        //what direction to step in x or y-direction (either +1 or -1)
-        /*
-        stepX: 
-            - +1 if the ray is moving right (positive X direction).
-            - -1 if the ray is moving left (negative X direction).
-
-        stepY:
-            - +1 if the ray is moving down (positive Y direction).
-            - -1 if the ray is moving up (negative Y direction).
-
-        */
-        int stepX;
-        int stepY;
-        
-        // calculate step and initial sideDist
-        if(rayDir.x < 0) { // negative
-            stepX = -1; // Moving left
-            sideDistX = ((Player->Position.x/mapScale) - mapx) * deltaDistX; // The difference gives the distance to the previous vertical grid line.
-
-        } else { // positive
-            stepX = 1; // Moving right
-            sideDistX = (mapx + 1 - (Player->Position.x/mapScale)) * deltaDistX; // mapx + 1.0 is the next vertical grid line on the right
-        }
+void RayCasting::beginCasting() {
 
-        if(rayDir.y < 0) { // negative
-            stepY = -1;
-            sideDistY = ((Player->Position.y/mapScale) - mapy) * deltaDistY; // The difference gives the distance to the previous grid line
-        }
-        else { // positive
-            stepY = 1;
-            sideDistY = (mapy + 1 - (Player->Position.y/mapScale)) * deltaDistY; // mapY + 1.0 is the next horizontal grid line below
-        }
+    // New frame for the visited cells
+    // On the (very unlikely) wrap around the old stamps would look current, so they are reset
+    if(++frameStamp == 0) {
+        std::fill(visitedStamp.begin(), visitedStamp.end(), 0);
+        std::fill(gatheredStamp.begin(), gatheredStamp.end(), 0);
+        frameStamp = 1;
+    }
+    visitedCells.clear();
 
-        int hit = 0; // Was there a wall hit?
-        int side; // It hitted vertically or horizontally? - Used to apply the shadowing
+    // The player cell is always visible
+    visitCell(static_cast<int>(Player->Position.x/mapScale), static_cast<int>(Player->Position.y/mapScale));
+}
 
+void RayCasting::castRay(int x, RayHit& ray) {
 
-        // Peforms de DDA
-        while(hit == 0) {
-            //jump to next map square, either in x-direction, or in y-direction
-            if(sideDistX < sideDistY) {
+    // calculate ray position and direction
+    
+    /*
+    cameraX is the x-coordinate on the camera plane that the current x-coordinate of the screen represents, 
+    done this way so that the right side of the screen will get coordinate 1, the center of the screen gets coordinate 0, 
+    and the left side of the screen gets coordinate -1.
+    */
+
+    float cameraX = 2 * x / static_cast<float>(Width/2) - 1; //gets the x-coordinate of the ray in the
+    glm::vec2 rayDir = glm::vec2(Player->direction.x + Player->plane.x * cameraX, Player->direction.y + Player->plane.y * cameraX);
+    
+    // The amount of units to the ray hit the next tile
+    glm::vec2 deltaDist = glm::vec2(std::abs(1/rayDir.x), std::abs(1/rayDir.y));
 
-                sideDistX += deltaDistX;
-                mapx += stepX; // Moves to the following tile
-                side = 0; // It hitted vertically
-            }
-            else {
-                sideDistY += deltaDistY;
-                mapy += stepY;
-                side = 1;
-            }
-            
-            // THE ORIGINAL COORDINATES ARE FLIPPED, SO THE Y-AXIS IS IN THE TILE DATA WIDTH AND MAPX IN THE TILE DATA HEIGHT
-            //Check if ray has hit a wall
-            if(Level->tileData[mapy][mapx]) hit = 1; 
+
+    //Which box of the map we're in
+    int mapx = ((static_cast<int>(Player->Position.x/mapScale)));
+    int mapy = ((static_cast<int>(Player->Position.y/mapScale)));
+   
+    //length of ray from current position to next x or y-side
+    float sideDistX;
+    float sideDistY;
+
+    /*
+    length of ray from one x or y-side to next x or y-side
+    these are derived as:
+    deltaDistX = sqrt(1 + (rayDirY * rayDirY) / (rayDirX * rayDirX))
+    deltaDistY = sqrt(1 + (rayDirX * rayDirX) / (rayDirY * rayDirY))
+    which can be simplified to abs(|rayDir| / rayDirX) and abs(|rayDir| / rayDirY)
+    where |rayDir| is the length of the vector (rayDirX, rayDirY). Its length,
+    unlike (dirX, dirY) is not 1, however this does not matter, only the
+    ratio between deltaDistX and deltaDistY matters, due to the way the DDA
+    stepping further below works
+    */
+    float deltaDistX = std::abs(1/rayDir.x);
+    float deltaDistY = std::abs(1/rayDir.y);
+
+    //what direction to step in x or y-direction (either +1 or -1)
+    /*
+    stepX: 
+        - +1 if the ray is moving right (positive X direction).
+        - -1 if the ray is moving left (negative X direction).
+
+    stepY:
+        - +1 if the ray is moving down (positive Y direction).
+        - -1 if the ray is moving up (negative Y direction).
+
+    */
+    int stepX;
+    int stepY;
+    
+    // calculate step and initial sideDist
+    if(rayDir.x < 0) { // negative
+        stepX = -1; // Moving left
+        sideDistX = ((Player->Position.x/mapScale) - mapx) * deltaDistX; // The difference gives the distance to the previous vertical grid line.
+
+    } else { // positive
+        stepX = 1; // Moving right
+        sideDistX = (mapx + 1 - (Player->Position.x/mapScale)) * deltaDistX; // mapx + 1.0 is the next vertical grid line on the right
+    }
+
+    if(rayDir.y < 0) { // negative
+        stepY = -1;
+        sideDistY = ((Player->Position.y/mapScale) - mapy) * deltaDistY; // The difference gives the distance to the previous grid line
+    }
+    else { // positive
+        stepY = 1;
+        sideDistY = (mapy + 1 - (Player->Position.y/mapScale)) * deltaDistY; // mapY + 1.0 is the next horizontal grid line below
+    }
+
+    int hit = 0; // Was there a wall hit?
+    int side; // It hitted vertically or horizontally? - Used to apply the shadowing
+
+
+    // Peforms de DDA
+    while(hit == 0) {
+        //jump to next map square, either in x-direction, or in y-direction
+        if(sideDistX < sideDistY) {
+
+            sideDistX += deltaDistX;
+            mapx += stepX; // Moves to the following tile
+            side = 0; // It hitted vertically
         }
+        else {
+            sideDistY += deltaDistY;
+            mapy += stepY;
+            side = 1;
+        }
+        
+        // Saves the cell for the sprite casting (the wall cell too)
+        visitCell(mapx, mapy);
 
-        /*
-        Calculate distance projected on camera direction. This is the shortest distance from the point where the wall is
-        hit to the camera plane. Euclidean to center camera point would give fisheye effect!
-        This can be computed as (mapX - posX + (1 - stepX) / 2) / rayDirX for side == 0, or same formula with Y
-        for size == 1, but can be simplified to the code below thanks to how sideDist and deltaDist are computed:
-        because they were left scaled to |rayDir|. sideDist is the entire length of the ray above after the multiple
-        steps, but we subtract deltaDist once because one step more into the wall was taken above.
-        */
+        // THE ORIGINAL COORDINATES ARE FLIPPED, SO THE Y-AXIS IS IN THE TILE DATA WIDTH AND MAPX IN THE TILE DATA HEIGHT
+        //Check if ray has hit a wall
+        if(Level->tileData[mapy][mapx]) hit = 1; 
+    }
 
-        float perpWallDistance;
+    /*
+    Calculate distance projected on camera direction. This is the shortest distance from the point where the wall is
+    hit to the camera plane. Euclidean to center camera point would give fisheye effect!
+    This can be computed as (mapX - posX + (1 - stepX) / 2) / rayDirX for side == 0, or same formula with Y
+    for size == 1, but can be simplified to the code below thanks to how sideDist and deltaDist are computed:
+    because they were left scaled to |rayDir|. sideDist is the entire length of the ray above after the multiple
+    steps, but we subtract deltaDist once because one step more into the wall was taken above.
+    */
+
+    float perpWallDistance;
+
+    if(side == 0) perpWallDistance = (sideDistX - deltaDistX);  // Goes one step back
+    else          perpWallDistance = (sideDistY - deltaDistY); // Goes one step back
+
+    // Calculate the position of the ray referenced to the wall (player position + raydist*distance offset)]
+    float wallX; // where exactly the wall was hit
+    if(side == 0) wallX = (Player->Position.y/mapScale) + perpWallDistance * rayDir.y;
+    else          wallX = (Player->Position.x/mapScale) + perpWallDistance * rayDir.x;
+
+    wallX -= floor(wallX); // Lower approx of the wall position
+
+    ray.RayDir = rayDir;
+    ray.Distance = perpWallDistance;
+    ray.MapX = mapx;
+    ray.MapY = mapy;
+    ray.Side = side;
+    ray.WallX = wallX;
+}
 
-        if(side == 0) perpWallDistance = (sideDistX - deltaDistX);  // Goes one step back
-        else          perpWallDistance = (sideDistY - deltaDistY); // Goes one step back
+void RayCasting::WallCasting(std::vector<float>& zBuffer) {
+ 
+    // Set a variable to store the texture
+    TextureHandle currentTexture;
+
+    // New frame for the visited cells
+    beginCasting();
+
+    // Each interation creates a ray which are distributed throught the plane(screen) space;
+    // Our screen is split in half
+    // The slices never overlap, so they are kept and drawn with one draw call per wall texture
+    WallRenderer->Begin();
+    for(int x = 0; x < Width/2; x+= rayDensity) {
+        // Casts the ray of the column through the grid
+        RayHit ray;
+        castRay(x, ray);
+        float perpWallDistance = ray.Distance;
 
         //calculate lowest and highest pixel to fill in current stripe
         float lineHeight = (Height/(perpWallDistance));
@@ -167,61 +276,52 @@ void RayCasting::WallCasting(std::vector<float>& zBuffer) {
         // =============== TEXTURING HANDLING ==================
         
         // Load the texture from the tile
-        currentTexture = Level->tileInfo[mapy][mapx].Sprite;
+        currentTexture = Level->tileInfo[ray.MapY][ray.MapX].Sprite;
 
         
-        float step = 1.0f * currentTexture.Height / lineHeight; // The step to take in the texture
+        float step = 1.0f * currentTexture->Height / lineHeight; // The step to take in the texture
         // Pick the wall color
         glm::vec3 color = glm::vec3(1.0, 1.0, 1.0);
 
 
-        // Calculate the position of the ray referenced to the wall (player position + raydist*distance offset)]
-        float wallX; // where exactly the wall was hit
-        if(side == 0) wallX = (Player->Position.y/mapScale) + perpWallDistance * rayDir.y;
-        else          wallX = (Player->Position.x/mapScale) + perpWallDistance * rayDir.x;
-
-        wallX -= floor(wallX); // Lower approx of the wall position
 
         // x coordinate on the texture
-        float texX = wallX * static_cast<float>(currentTexture.Width);
+        float texX = ray.WallX * static_cast<float>(currentTexture->Width);
 
         // Corrects the flipping textures
         //if(side == 0 && rayDir.x > 0) texX = static_cast<float>(mytexture.Width) - texX - 1.0f;
         //if(side == 1 && rayDir.x < 0) texX = static_cast<float>(mytexture.Width) - texX - 1.0f;
 
-        float texXNormalized = texX/static_cast<float>(currentTexture.Width);
-
+        float texXNormalized = texX/static_cast<float>(currentTexture->Width);
 
-        // Sets the uniform to draw only the pre defined slice
-        ResourceManager::GetShader("wall").Use().SetFloat("texXOffset", texXNormalized);
 
         // Create shading
-        if(side == 1) color = glm::vec3(0.5f, 0.5f, 0.5f);
+        if(ray.Side == 1) color = glm::vec3(0.5f, 0.5f, 0.5f);
 
    
     
-        // Create a gameObject to draw on the screen
+        // Wall slice to draw on the screen
 
         // x + Width/2 = Starting X-coordinate
         // drawStart = Y Starting coordinate 
-        // Size = (Density of the ray = 1 pixel, drawEnd - drawStart)
-
-        
-        wallObj->Position = glm::vec2(x+ Width/2, drawStart);
-        wallObj->Size = glm::vec2(this->rayDensity, drawEnd - drawStart);
-        wallObj->Sprite = currentTexture;
-        wallObj->Color = color;
-        
+        // Height = drawEnd - drawStart (the width is the ray density)
+        glm::vec4 column(x + Width/2, drawStart, drawEnd - drawStart, texXNormalized);
 
         // Draw wall slice
-        wallObj->Draw(*WallRenderer);
+        WallRenderer->DrawColumn(currentTexture, column, static_cast<float>(rayDensity), color);
 
         zBuffer[x] = perpWallDistance;
         //std::cout << perpWallDistance << std::endl;
 
     }
+    WallRenderer->End();
+
+    // Coarse version of the ZBuffer to reject the sprites hidden behind walls
+    wallDepth.Build(zBuffer);
 
-    ResourceManager::GetShader("sprite").Use().SetVec1("ZBuffer", zBuffer.data(), Width/2);
+    // The GPU sprite path tests the depth in the fragment shader
+    if(!spriteRasterizer)
+        depthTexture.Upload(zBuffer);
       
 
 }
@@ -233,7 +333,14 @@ void RayCasting::FloorCeilingCasting() {
    //  Texture2D ceilingBuffer = ResourceManager::GetTexture(7);
 
     // Buffer that will store the custom texture for the floor
-    std::vector<unsigned char> pixelBuffer(Width * Height * 3); // RGB
+    std::vector<unsigned char> pixelBuffer(Width * Height * 4); // RGBA
+
+    // Pixels not reached by the casting stay opaque black
+    for(size_t i = 3; i < pixelBuffer.size(); i += 4) pixelBuffer[i] = 255;
+
+    // CPU-side texels of all the textures
+    const TexelArena& arena = ResourceManager::Arena;
+    const unsigned char* texels = arena.Data();
 
     for(int y = Height/2; y < Height; y+= rayDensity) { // Mid to bottom of the screen
 
@@ -242,16 +349,8 @@ void RayCasting::FloorCeilingCasting() {
         glm::vec2 rayDirLeft = glm::vec2(Player->direction.x - Player->plane.x, Player->direction.y - Player->plane.y);
         glm::vec2 rayDirRight = glm::vec2(Player->direction.x + Player->plane.x, Player->direction.y + Player->plane.y);
 
-        // Current Y position of the ray compared to the center of the screen
-        int p = y - Height/2;
-
-        // Vertical position of the camera in pixels
-        float posZ = 0.5 * Height; // Camera on the center of the screen
-        /*
-        Horizontal distance from the camera to the floor. Based on triangle equivalence:
-        rowDistance/1 = posZ/p;  Since the distance from the camera to the screen is always 1
-        */
-        float rowDistance = posZ/p;
+        // Horizontal distance from the camera to the floor seen by this row
+        float rowDistance = FloorRowDistance(Height, y);
 
        // std::cout << rowDistance << std::endl;
 
@@ -277,37 +376,47 @@ void RayCasting::FloorCeilingCasting() {
             cellY >= 0 && cellY < mapSizeGridY) {
  
 
-                Texture2D& floorTex = Level->floorInfo[cellY][cellX].Sprite;
-                Texture2D& ceilTex  = Level->ceilingInfo[cellY][cellX].Sprite;
+                // Open cells skip all the ceiling work
+                bool isSky = Level->ceilingData[cellY][cellX] == SKY_CELL;
+                // Texels of the floor and ceiling textures inside the arena
+                // Every texture has the same size there, so one texel offset works for both
+                // The sky cells have no ceiling texture, so they never read its offset
+                int cell = cellY * mapSizeGridX + cellX;
+                assert(Level->floorTexels[cell] != SIZE_MAX);
+                const unsigned char* floorTexels = texels + Level->floorTexels[cell];
                 
                 
                 // .f part of the floor current position
                 glm::vec2 fractional = glm::vec2(floor.x - cellX, floor.y - cellY);
                 
                 // Gets the exact pixel coodinate in the texture based on the floor position
-                int texX = (int)(floorTex.Width * fractional.x) & (floorTex.Width -1); // Bitmask when texture width is power of two
-                int texY = (int)(floorTex.Height * fractional.y) & (floorTex.Height- 1); // Bitmask when texture heght is power of two
+                int texX = (int)(arena.Size * fractional.x) & arena.Mask; // Bitmask, the arena size is a power of two
+                int texY = (int)(arena.Size * fractional.y) & arena.Mask;
                 
                 // std::cout << cellX << " " << cellY << std::endl;
                 
                 // Convert the pixel cordinate into the pixel position in the buffer array
-                int texIndex = (texY * floorTex.Width + texX) * 3; // 3 bytes per pixel (RGB)
+                // The arena decides the order of the texels (row-major, tiled or Z-order)
+                int texIndex = arena.TexelOffset(texX, texY);
                 
                 // Gets the index of the pixel based on the screen coodinate
-                int screenIndexFloor = (y * (Width/2) + x) * 3;
-                int screenIndexCeiling = ((Height - y) * (Width/2) + x ) * 3;
+                int screenIndexFloor = (y * (Width/2) + x) * 4;
+                int screenIndexCeiling = ((Height - y) * (Width/2) + x ) * 4;
 
 
-                // Write each pixel to the buffer -> Each pixel contains an RGB value
+                // Write each pixel to the buffer -> Each pixel is one aligned RGBA texel (alpha is always 255 in the arena)
                 // Buffer part for the floor
-                pixelBuffer[screenIndexFloor + 0] = floorTex.PixelBuffer[texIndex + 0]; // Red
-                pixelBuffer[screenIndexFloor + 1] = floorTex.PixelBuffer[texIndex + 1]; // Green
-                pixelBuffer[screenIndexFloor + 2] = floorTex.PixelBuffer[texIndex + 2]; // Blue
+                std::memcpy(&pixelBuffer[screenIndexFloor], floorTexels + texIndex, 4);
                 
                 // Buffer part for the ceiling
-                pixelBuffer[screenIndexCeiling + 0] = ceilTex.PixelBuffer[texIndex + 0]; // Red
-                pixelBuffer[screenIndexCeiling + 1] = ceilTex.PixelBuffer[texIndex + 1]; // Green    
-                pixelBuffer[screenIndexCeiling + 2] = ceilTex.PixelBuffer[texIndex + 2]; // Blue
+                // The sky cells are left transparent, so the sky drawn before shows through
+                if(isSky) {
+                    pixelBuffer[screenIndexCeiling + 3] = 0; // Alpha
+                }
+                else {
+                    assert(Level->ceilingTexels[cell] != SIZE_MAX);
+                    std::memcpy(&pixelBuffer[screenIndexCeiling], texels + Level->ceilingTexels[cell] + texIndex, 4);
+                }
                 
                 
             }
@@ -332,130 +441,316 @@ void RayCasting::FloorCeilingCasting() {
 
     floorObj->Position = glm::vec2(Width/2, 0);
     floorObj->Size = glm::vec2(Width, 2*Height);
-    floorObj->Sprite = *floorTexture;
+    floorObj->Sprite = TextureHandle(*floorTexture);
     floorObj->Color = glm::vec3(0.5f, 0.5f, 0.5f);
     
     floorObj->Draw(*FloorRenderer);
 }
 
+// ===================== SKY CASTING ALGORRITHM =====================
+void RayCasting::SkyCasting() {
+
+    // Indoor levels have a ceiling everywhere
+    if(!Level->HasSky) return;
+
+    float skyOffset, skySpan;
+    skyCoordinates(skyOffset, skySpan);
+
+    skyShader->Use().SetFloat(skyOffsetLocation, skyOffset);
+    skyShader->SetFloat(skySpanLocation, skySpan);
+
+    // A single quad covering the upper half of the 3D view
+    // The ceiling casting leaves the sky pixels transparent, so walls and ceilings cover it
+    skyObj->Position = glm::vec2(Width/2, 0);
+    skyObj->Size = glm::vec2(Width/2, Height/2);
+    skyObj->Color = glm::vec3(1.0f, 1.0f, 1.0f);
+
+    skyObj->Draw(*SkyRenderer);
+}
+
+void RayCasting::skyCoordinates(float& skyOffset, float& skySpan) const {
+
+    // The sky wraps around the player, so the texture offset follows the view angle
+    float angle = std::atan2(Player->direction.y, Player->direction.x);
+    float fov = 2.0f * std::atan(glm::length(Player->plane) / glm::length(Player->direction));
+
+    // Which side of the direction the plane points to defines if the texture goes left or right
+    float side = (Player->direction.x * Player->plane.y - Player->direction.y * Player->plane.x) < 0 ? -1.0f : 1.0f;
+
+    skyOffset = angle / (2.0f * M_PI) * SKY_REPEATS;
+    skySpan = side * fov / (2.0f * M_PI) * SKY_REPEATS;
+}
+
 // ===================== SPRITE CASTING ALGORRITHM =====================
 void RayCasting::SpriteCasting(std::vector<float>& zBuffer) {
 
-    // Sort the sprites based on distance and save it on a distance array
-    for(int i = 0; i < numSprites; i++) {
+    // Projected, sorted and visible sprites of the frame
+    buildSpriteInstances();
+
+    // CPU path: rasterize the sprites and draw the result as one layer over the walls
+    if(spriteRasterizer) {
+        spriteRasterizer->DrawSprites(spriteInstances, zBuffer, ResourceManager::Arena, ResourceManager::CompiledSprites, Width/2);
 
-        glm::vec2 spritePos = glm::vec2(Level->elementsInfo[i].Position.x, Level->elementsInfo[i].Position.y);
+        // Calls Generate only once, same as the floor buffer
+        if(!spriteLayerTexture->IsInitialized)
+            spriteLayerTexture->Generate(spriteRasterizer->Width, spriteRasterizer->Height, spriteRasterizer->Pixels.data());
+        else
+            spriteLayerTexture->Update(spriteRasterizer->Pixels.data());
 
-        // Assing an ID to the sprite
-        spriteOrder[i] = i;
-        // Calculates sprite distance relative to the player
-        spriteDistance[i] = ((Player->Position.x - spritePos.x) * (Player->Position.x - spritePos.x) +
-                            (Player->Position.y - spritePos.y) * (Player->Position.y - spritePos.y));
-                            
+        spriteLayerObj->Position = glm::vec2(Width/2, 0);
+        spriteLayerObj->Size = glm::vec2(Width/2, Height);
+        spriteLayerObj->Sprite = TextureHandle(*spriteLayerTexture);
+        spriteLayerObj->Color = glm::vec3(1.0f, 1.0f, 1.0f);
+
+        spriteLayerObj->Draw(*spriteLayerRenderer);
+        return;
     }
 
+    // All the visible sprites in one draw, from the farthest to the nearest
+    SpRenderer->DrawSprites(ResourceManager::TextureLayers, depthTexture, spriteInstances);
+
+}
+
+void RayCasting::buildSpriteInstances() {
+
+    // Only the sprites near the cells crossed by the rays can be on the screen
+    gatherSprites();
+    // The far clusters are drawn as one impostor each
+    if(useImpostors) gatherImpostors();
+
+    // ============ PROJECTION ==============
+
+    // Copies the candidates into the batch arrays
+    projection.Resize(spriteOrder.size());
+    for(unsigned int i = 0; i < spriteOrder.size(); i++) {
+        int id = spriteOrder[i];
+
+        // Texture and width (in sprites) of the entry
+        unsigned int layer;
+        if(id >= 0 && static_cast<unsigned int>(id) < numSprites) {
+            projection.X[i] = spriteX[id];
+            projection.Y[i] = spriteY[id];
+            projection.WidthScale[i] = 1.0f;
+            layer = spriteLayer[id];
+        }
+        else {
+            const SpriteClusters::Cluster& cluster = spriteClusters.Clusters[id - numSprites];
+            glm::vec2 position = spritePosition(id) / mapScale;
+            projection.X[i] = position.x;
+            projection.Y[i] = position.y;
+            projection.WidthScale[i] = cluster.Width / spritePlaneWidth;
+            layer = cluster.Layer;
+        }
+
+        // Only the tight rectangle around the opaque texels is drawn
+        const CompiledSprite& shape = ResourceManager::CompiledSprites[layer];
+        glm::vec4 bounds = shape.Empty ? glm::vec4(0.0f) : shape.PaddedBounds();
+        projection.U0[i] = bounds.x;
+        projection.V0[i] = bounds.y;
+        projection.U1[i] = bounds.z;
+        projection.V1[i] = bounds.w;
+    }
+
+    // Distance, camera transform, screen rectangle and clipping of the whole batch
+    SpriteCamera camera;
+    camera.Position = Player->Position / mapScale;
+    camera.Direction = Player->direction;
+    camera.Plane = Player->plane;
+    camera.Width = static_cast<float>(Width);
+    camera.Height = static_cast<float>(Height);
+    projection.Project(camera);
+
+    // Keeps only the visible entries (and where their results are in the batch)
+    unsigned int visible = 0;
+    for(unsigned int i = 0; i < projection.Count; i++) {
+        if(!projection.Visible[i]) continue;
+        projectionSlot[spriteOrder[i]] = i;
+        spriteOrder[visible++] = spriteOrder[i];
+    }
+    spriteOrder.resize(visible);
+
+    // Sort the sprites based on distance and save it on a distance array
+    spriteDistance.resize(visible);
+    for(unsigned int i = 0; i < visible; i++)
+        spriteDistance[i] = projection.Distance[projectionSlot[spriteOrder[i]]];
+
     // Calls the sort sprite method
     SortSprites();
 
-    
-    // Converts the sprite coordinates in the view space (relative to the camera)
-    for(int i = 0; i < numSprites; i++) {
+    // The instance list keeps its memory between frames
+    spriteInstances.clear();
+
+    for(unsigned int i = 0; i < spriteOrder.size(); i++) {
+
+    int id = spriteOrder[i];
+    unsigned int slot = projectionSlot[id];
+
+    // Skip the sprite if the walls cover all its columns (pixel centers inside the quad)
+    int firstColumn = static_cast<int>(std::ceil(projection.StartX[slot] - 0.5f)) - Width/2;
+    int lastColumn = static_cast<int>(std::ceil(projection.EndX[slot] - 0.5f)) - Width/2;
+    if(wallDepth.Occluded(firstColumn, lastColumn, projection.Depth[slot])) continue;
+
+    // Queue the sprite instance
+    // The transformY goes to the fragment shader to test it against the ZBuffer
+    // The impostors already have the tint of each sprite
+    SpriteInstance instance;
+    instance.Position = glm::vec2(projection.StartX[slot], projection.StartY[slot]);
+    instance.Size = glm::vec2(projection.EndX[slot], projection.EndY[slot]) - instance.Position;
+    instance.UV = glm::vec4(projection.ClipU0[slot], projection.V0[slot], projection.ClipU1[slot], projection.V1[slot]);
+    instance.Depth = projection.Depth[slot];
+    if(id >= 0 && static_cast<unsigned int>(id) < numSprites) {
+        instance.Layer = static_cast<float>(spriteLayer[id]);
+        instance.DepthRange = 0.0f;
+        instance.Color = Level->elementsInfo[id].Color;
+    }
+    else {
+        const SpriteClusters::Cluster& cluster = spriteClusters.Clusters[id - numSprites];
+        instance.Layer = static_cast<float>(cluster.Layer);
+        instance.DepthRange = cluster.DepthRange;
+        instance.Color = glm::vec3(1.0f);
+    }
+    spriteInstances.push_back(instance);
         
-    // Translate sprite position to relative to camera
-    glm::vec2 spriteCoord = glm::vec2((Level->elementsInfo[spriteOrder[i]].Position.x/mapScale) - (Player->Position.x/mapScale),
-    (Level->elementsInfo[spriteOrder[i]].Position.y/mapScale) - (Player->Position.y/mapScale));
-    
-    //transform sprite with the inverse camera matrix
-    // [ planeX   dirX ] -1                                       [ dirY      -dirX ]
-    // [               ]       =  1/(planeX*dirY-dirX*planeY) *   [                 ]
-    // [ planeY   dirY ]                                          [ -planeY  planeX ]
-    float invDet = 1.0f / (Player->plane.x * Player->direction.y - Player->direction.x * Player->plane.y);
-    
-    
-    // spriteTransform.x = Where the sprite appears horizontally relative to the camera(left or right)
-    // spriteTransform.y = how far away the sprite is (depth)
-    glm::vec2 spriteTransform = glm::vec2(invDet * (Player->direction.y * spriteCoord.x - Player->direction.x * spriteCoord.y),
-                                          invDet * (-Player->plane.y * spriteCoord.x + Player->plane.x * spriteCoord.y));   
-    
-    // Computes the sprite's camera-space X coordinate to the 2D screen
-    // The width is divided by 4 because we use only half of the screen
-    int spriteScreenX = static_cast<int>( ((Width/4) * (1 + spriteTransform.x/ spriteTransform.y) + (Width/2)));
-    //std::cout << spriteTransform.x << std::endl;
-    // Calculates the height and width of the sprite on screen
-    // As the transformY gets bigger, smaller will the the sprite
-    int spriteHeight = abs(static_cast<int>(Height/(spriteTransform.y)));
-    int spriteWidth = abs(static_cast<int>(Height/(spriteTransform.y)));
-    // Gets the drawing coordinates
-    
-    // Original drawing coord without clamping
-    float originalStartX = -spriteWidth/2 + spriteScreenX;
-    float originalEndX = spriteWidth/2 + spriteScreenX;
+    }
+}
 
-    // Creates the drawing coord vectors
-    glm::vec2 drawStart = glm::vec2(originalStartX, -spriteHeight/2 + Height/2);
-    glm::vec2 drawEnd = glm::vec2(originalEndX, spriteHeight/2 + Height/2);
-    
-    // Clamp the horizontal drawing
-    drawStart.x = std::max(drawStart.x, static_cast<float>(Width/2));
-    drawEnd.x = std::min(drawEnd.x, static_cast<float>(Width)); 
-
-    // ============ TEXTURE HANDLING ==============
-
-    // Calculate the portion of the texture which need to be drawn
-    // Normalized texX coordinate range
-    // uv_coord_start = percentace of where the drawing tex should start
-    // uv_coord_end = percentace of where the drawing tex should end
-    float uv_coord_start = (drawStart.x - originalStartX) / (originalEndX - originalStartX);
-    float uv_coord_end = (drawEnd.x - originalStartX) / (originalEndX - originalStartX); 
-    
-    // 
-    ResourceManager::GetShader("sprite").Use().SetFloat("u_start", uv_coord_start);
-    ResourceManager::GetShader("sprite").Use().SetFloat("u_end", uv_coord_end);
+// ===================== SOFTWARE RENDERING =====================
+void RayCasting::SoftwareCasting(std::vector<float>& zBuffer) {
 
+    // Same rays as the wall casting, kept per column instead of drawn
+    beginCasting();
 
-    // If the sprite is not behind the player
-    if(spriteTransform.y > 0) {
+    const TexelArena& arena = ResourceManager::Arena;
+    for(int x = 0; x < static_cast<int>(Width/2); x += rayDensity) {
+        RayHit ray;
+        castRay(x, ray);
 
-        //std::cout << "Sprite: "<<spriteTransform.y << std::endl;
+        float lineHeight = Height / ray.Distance;
+        TextureHandle wallTexture = Level->tileInfo[ray.MapY][ray.MapX].Sprite;
 
-        // Pass the transformY to the fragment shader
-        ResourceManager::GetShader("sprite").Use().SetFloat("spriteDepth", spriteTransform.y);
-        
-        // Set the Quad dimensions
+        SoftwareColumn column;
+        column.RayDir = ray.RayDir;
+        column.WallStart = -lineHeight / 2 + Height / 2;
+        column.WallEnd = lineHeight / 2 + Height / 2;
+        column.WallTexels = wallTexture->ArenaOffset;
+        column.WallTexX = static_cast<unsigned int>(ray.WallX * arena.Size) & arena.Mask;
+        column.Shaded = ray.Side == 1;
 
-        // Create a gameObject to draw on the screen
-    
-        // X + Width/2 = Starting X-coordinate
-        // drawStart = Y Starting coordinate 
-        // Size = (Density of the ray = 1 pixel, drawEnd - drawStart)
-        spriteObj->Position = drawStart; 
-        spriteObj->Size =  drawEnd - drawStart;
-        spriteObj->Sprite = Level->elementsInfo[spriteOrder[i]].Sprite;
-        spriteObj->Color = Level->elementsInfo[spriteOrder[i]].Color;
-        
-        spriteObj->Draw(*SpRenderer);
+        // With a ray density above 1 the next columns repeat this ray, like the wider GL slices
+        for(int i = x; i < std::min<int>(x + rayDensity, Width/2); i++) {
+            softwareRenderer->Columns[i] = column;
+            zBuffer[i] = ray.Distance;
+        }
     }
-        
+    wallDepth.Build(zBuffer);
+
+    // Sky, ceiling, walls and floor into the CPU framebuffer
+    SoftwareSky sky;
+    if(Level->HasSky && skyObj->Sprite.Valid()) {
+        sky.Enabled = true;
+        sky.Texels = skyObj->Sprite->ArenaOffset;
+        skyCoordinates(sky.Offset, sky.Span);
     }
+    softwareRenderer->DrawScene(*Level, Player->Position / mapScale, arena, sky);
 
+    // The sprites go over it, then the whole view is one upload and one quad
+    buildSpriteInstances();
+    spriteRasterizer->DrawSpritesOver(softwareRenderer->Pixels, spriteInstances, zBuffer, arena, ResourceManager::CompiledSprites, Width/2,
+                                      softwareRenderer->IndexPalette);
+    softwareRenderer->Present(*softwarePresenter, glm::vec2(Width/2, 0));
 }
 
 void RayCasting::SortSprites() {
 
-    // Joins the sprite distance with its ID
-    std::vector<std::pair<float, int>> sprites(numSprites);
-    for(int i = 0; i < numSprites; i++) {
-        sprites[i].first = spriteDistance[i];
-        sprites[i].second = spriteOrder[i];
+    // Far to near, seeded with the order of the last frame
+    spriteSorter.Sort(spriteOrder, spriteDistance);
+
+}
+
+void RayCasting::visitCell(int mapx, int mapy) {
+
+    // The rays can start outside the map if the player is on the border
+    if(mapx < 0 || mapx >= static_cast<int>(mapSizeGridX) || mapy < 0 || mapy >= static_cast<int>(mapSizeGridY)) return;
+
+    unsigned int cell = Level->spriteGrid.CellIndex(mapx, mapy);
+    if(visitedStamp[cell] == frameStamp) return; // Already crossed by another ray
+
+    visitedStamp[cell] = frameStamp;
+    visitedCells.push_back(cell);
+}
+
+void RayCasting::gatherSprites() {
+
+    const SpriteGrid& grid = Level->spriteGrid;
+    spriteOrder.clear();
+
+    // A sprite stands on the corner of its cell and is about one cell wide,
+    // so it can cover the neighbour cells too. Those are gathered as well
+    for(unsigned int cell : visitedCells) {
+        int cellX = cell % grid.Width;
+        int cellY = cell / grid.Width;
+
+        for(int y = std::max(cellY - 1, 0); y <= std::min(cellY + 1, static_cast<int>(grid.Height) - 1); y++) {
+            for(int x = std::max(cellX - 1, 0); x <= std::min(cellX + 1, static_cast<int>(grid.Width) - 1); x++) {
+
+                unsigned int neighbour = grid.CellIndex(x, y);
+                if(gatheredStamp[neighbour] == frameStamp) continue;
+                gatheredStamp[neighbour] = frameStamp;
+
+                for(const unsigned int* id = grid.CellBegin(neighbour); id != grid.CellEnd(neighbour); id++)
+                    spriteOrder.push_back(*id);
+            }
+        }
     }
+}
 
-    // Sorts the distances
-    std::sort(sprites.begin(), sprites.end());
+void RayCasting::gatherImpostors() {
 
-    // restore in reverse order to go from farthest to nearest
-    for(int i = 0; i < numSprites; i++) {
-        spriteDistance[i] = sprites[numSprites - i - 1].first;
-        spriteOrder[i] = sprites[numSprites - i - 1].second;
-      }
+    glm::vec2 playerCell = Player->Position / mapScale;
 
-}
\ No newline at end of file
+    // Counts the gathered sprites of each cluster
+    for(int id : spriteOrder) {
+        unsigned int cluster = spriteClusters.SpriteCluster[id];
+        if(clusterStamp[cluster] != frameStamp) {
+            clusterStamp[cluster] = frameStamp;
+            clusterGathered[cluster] = 0;
+        }
+        clusterGathered[cluster]++;
+    }
+
+    // Keeps the sprites drawn one by one and lists each far cluster only once.
+    // The impostor shows every sprite of its cluster, so a cluster that is only
+    // partly gathered (at the border of the view) stays as single sprites
+    unsigned int kept = 0;
+    for(unsigned int i = 0; i < spriteOrder.size(); i++) {
+        int id = spriteOrder[i];
+        unsigned int cluster = spriteClusters.SpriteCluster[id];
+        unsigned int& gathered = clusterGathered[cluster];
+
+        // Impostor already listed in this frame
+        if(gathered == CLUSTER_LISTED) continue;
+
+        if(gathered == spriteClusters.Clusters[cluster].Sprites.size()) {
+            if(spriteClusters.UseImpostor(cluster, playerCell, Player->direction, Player->plane,
+                                          Level->elementsInfo, mapScale, spritePlaneWidth, frameStamp)) {
+                gathered = CLUSTER_LISTED;
+                id = numSprites + cluster;
+            }
+            else
+                gathered = 0; // Drawn sprite by sprite, no need to ask again for its other sprites
+        }
+
+        spriteOrder[kept++] = id;
+    }
+    spriteOrder.resize(kept);
+}
+
+glm::vec2 RayCasting::spritePosition(int id) const {
+
+    if(id >= 0 && static_cast<unsigned int>(id) < numSprites)
+        return Level->elementsInfo[id].Position;
+
+    // The impostor is centered on its sprites along the camera plane
+    const SpriteClusters::Cluster& cluster = spriteClusters.Clusters[id - numSprites];
+    return (cluster.Center + Player->plane * cluster.Offset) * mapScale;
+}
@@ -8,9 +8,26 @@
 #include "gameLevel.h"
 #include "playerObject.h"
 #include "spriteRenderer.h"
+#include "spriteInstanceRenderer.h"
+#include "spriteSorter.h"
+#include "spriteRasterizer.h"
+#include "depthHierarchy.h"
+#include "depthTexture.h"
+#include "spriteClusters.h"
+#include "spriteProjection.h"
+#include "softwareRenderer.h"
 #include "gameObject.h"
 #include "texture.h"
 
+// What the ray of one screen column hit
+struct RayHit {
+    glm::vec2 RayDir;   // Direction of the ray
+    float Distance;     // Perpendicular distance to the wall (no fisheye)
+    int MapX, MapY;     // Wall cell
+    int Side;           // 0: x side of the cell, 1: y side (shaded)
+    float WallX;        // Where the wall was hit, 0 to 1 along the wall
+};
+
 class RayCasting  {
 
     public:
@@ -25,18 +42,28 @@ class RayCasting  {
         GameLevel* level,
         SpriteRenderer* wallRenderer,
         SpriteRenderer* floorRenderer,
-        SpriteRenderer* spriteRenderer,
-        GameObject* wallObj,
+        SpriteInstanceRenderer* spriteRenderer,
+        SpriteRenderer* skyRenderer,
         GameObject* floorObj,
-        GameObject* spriteObj,
+        GameObject* skyObj,
         Texture2D* floorTexture
     );
 
 
+    // Draws the sprites on the CPU instead of the instanced GPU path
+    // The rasterizer output is uploaded to layerTexture and drawn with layerRenderer
+    void EnableCpuSprites(SpriteRasterizer* rasterizer, SpriteRenderer* layerRenderer, GameObject* layerObj, Texture2D* layerTexture);
+    // Draws the far clusters of sprites as impostors (needs SPRITE_IMPOSTOR_LAYERS spare texture layers)
+    void EnableImpostors();
+    // Composes the whole 3D view on the CPU (SoftwareCasting) and draws it with presentRenderer
+    void EnableSoftwareRenderer(SoftwareRenderer* software, SpriteRasterizer* rasterizer, SpriteRenderer* presentRenderer);
+
     // Methods
     void WallCasting(std::vector<float>& zBuffer); // Wall rendering
     void FloorCeilingCasting(); // Floor and Ceiling rendering
+    void SkyCasting(); // Sky rendering behind the open ceiling cells
     void SpriteCasting(std::vector<float>& zBuffer); // Sprite rendering
+    void SoftwareCasting(std::vector<float>& zBuffer); // Sky, floor, ceiling, walls and sprites on the CPU, in place of the four above
     void SortSprites(); // Method to sort sprites based on their distances
 
     private:
@@ -52,16 +79,30 @@ class RayCasting  {
         // Renderers references
         SpriteRenderer* WallRenderer;
         SpriteRenderer* FloorRenderer;
-        SpriteRenderer* SpRenderer;
+        SpriteInstanceRenderer* SpRenderer;
+        SpriteRenderer* SkyRenderer;
 
         // Objects to be drawn
-        GameObject* wallObj;
         GameObject* floorObj;
-        GameObject* spriteObj;
+        GameObject* skyObj;
 
         // Textures
         Texture2D* floorTexture;
 
+        // Sky shader (stored in the ResourceManager) and the handles of its per-frame uniforms
+        Shader* skyShader;
+        GLint skyOffsetLocation, skySpanLocation;
+
+        // CPU sprite path (nullptr when the sprites are drawn on the GPU)
+        SpriteRasterizer* spriteRasterizer = nullptr;
+        SpriteRenderer* spriteLayerRenderer = nullptr;
+        GameObject* spriteLayerObj = nullptr;
+        Texture2D* spriteLayerTexture = nullptr;
+
+        // Software backend (nullptr when the view is drawn with GL)
+        SoftwareRenderer* softwareRenderer = nullptr;
+        SpriteRenderer* softwarePresenter = nullptr;
+
         float mapScale;
 
         unsigned int mapSizeGridX, mapSizeGridY;
@@ -72,7 +113,61 @@ class RayCasting  {
         // Array of sprite distances
         std::vector<float> spriteDistance;
         // Array to store the order of the sprites from fartest to the nearst
+        // Only the sprites close to the cells crossed by the rays are listed
         std::vector<int> spriteOrder;
+        // Keeps the ordering storage (and last frame's order) between frames
+        SpriteSorter spriteSorter;
+        // Position (map cells) and texture layer of each sprite, as flat arrays
+        std::vector<float> spriteX, spriteY;
+        std::vector<unsigned int> spriteLayer;
+        // Projection of the candidate sprites of the frame
+        SpriteProjection projection;
+        // Entry of each sprite / impostor id inside the projection batch
+        std::vector<unsigned int> projectionSlot;
+
+        // Sprite clusters drawn as impostors when far away
+        SpriteClusters spriteClusters;
+        bool useImpostors = false;
+        // Frame in which each cluster was counted, and its sprites gathered in that frame
+        // (CLUSTER_LISTED once its impostor is in the sprite list)
+        std::vector<unsigned int> clusterStamp;
+        std::vector<unsigned int> clusterGathered;
+        // Width of one sprite along the camera plane (the screen width of a sprite is Height/depth)
+        float spritePlaneWidth;
+
+        // Farthest wall over groups of columns, rebuilt after the wall casting
+        DepthHierarchy wallDepth;
+        // The ZBuffer on the GPU, read by the sprite fragment shader
+        DepthTexture depthTexture;
+        // Visible sprites of the frame, submitted as one instanced draw
+        std::vector<SpriteInstance> spriteInstances;
+
+        // Cells crossed by the wall rays in the current frame
+        std::vector<unsigned int> visitedCells;
+        // Frame in which each cell was last crossed / gathered. Comparing with the
+        // current frame avoids clearing the whole map every frame
+        std::vector<unsigned int> visitedStamp;
+        std::vector<unsigned int> gatheredStamp;
+        unsigned int frameStamp = 0;
+
+        // Starts a new frame of visited cells
+        void beginCasting();
+        // Casts the ray of the screen column x through the grid (marking the cells it crosses)
+        void castRay(int x, RayHit& ray);
+        // Texture u at the center of the view and u covered by the view, for the sky
+        void skyCoordinates(float& skyOffset, float& skySpan) const;
+        // Gathers, projects, sorts and culls the sprites of the frame into spriteInstances
+        void buildSpriteInstances();
+        // Marks a cell as crossed by a ray in this frame
+        void visitCell(int mapx, int mapy);
+        // Lists the sprites inside the visited cells and their neighbours
+        void gatherSprites();
+        // Replaces the sprites of the far clusters by their impostors
+        // The impostor of the cluster c is listed with the id numSprites + c
+        // A cluster with only some of its sprites gathered keeps them as single sprites
+        void gatherImpostors();
+        // Position (in map pixels) of a sprite or impostor id
+        glm::vec2 spritePosition(int id) const;
 
 
 };
@@ -9,6 +9,7 @@
 #include <filesystem>
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "stb_image.h"
 
@@ -17,23 +18,43 @@ namespace fs = std::filesystem;
 // Instantiate static variables
 std::map<int, Texture2D>  ResourceManager::Textures;
 std::vector<std::string> texturePaths;
-std::map<std::string, Shader> ResourceManager::Shaders;
-std::map<GLchar, Character> ResourceManager::Characters;
+std::deque<Shader> ResourceManager::ShaderList;
+std::map<std::string, ShaderHandle> ResourceManager::ShaderNames;
+TexelArena ResourceManager::Arena;
+Palette ResourceManager::ColorPalette;
+TextureArray ResourceManager::TextureLayers;
+std::vector<CompiledSprite> ResourceManager::CompiledSprites;
 
 
-Shader ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name)
+ShaderHandle ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, const std::string& name)
 {
-    Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
-    return Shaders[name];
+    Shader shader = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
+
+    // A known name keeps its handle (the old program is deleted by the move)
+    auto it = ShaderNames.find(name);
+    if(it != ShaderNames.end()) {
+        ShaderList[it->second] = std::move(shader);
+        return it->second;
+    }
+
+    ShaderHandle handle = ShaderList.size();
+    ShaderList.push_back(std::move(shader));
+    ShaderNames[name] = handle;
+    return handle;
 }
 
-Shader ResourceManager::GetShader(std::string name)
+ShaderHandle ResourceManager::FindShader(const std::string& name)
 {
-    return Shaders[name];
+    auto it = ShaderNames.find(name);
+    if(it == ShaderNames.end()) {
+        std::cerr << "ERROR::ResourceManager: Shader '" << name << "' not found!" << std::endl;
+        throw std::runtime_error("Shader not found in ResourceManager");
+    }
+    return it->second;
 }
 
 
-void ResourceManager::LoadTextures(const std::string& path_str)
+void ResourceManager::LoadTextures(const std::string& path_str, TexelLayout layout, unsigned int spareLayers, bool indexed)
 {
     // Create the directory path
     fs::path path(path_str);
@@ -70,6 +91,19 @@ void ResourceManager::LoadTextures(const std::string& path_str)
     if(entries.empty()) throw std::runtime_error("No textures avaiable");
 
 
+    // All the textures share the same size in the arena: the biggest side, rounded to a power of two
+    unsigned int largestSide = 1;
+    for(const auto& entry : entries) {
+        int width, height, nrChannels;
+        if(stbi_info(entry.path().string().c_str(), &width, &height, &nrChannels))
+            largestSide = std::max(largestSide, static_cast<unsigned int>(std::max(width, height)));
+    }
+    unsigned int layers = entries.size() + spareLayers;
+    Arena.Allocate(layers, TexelArena::SizeClass(largestSide), layout);
+    TextureLayers.Generate(Arena.Size, Arena.Size, layers);
+    CompiledSprites.assign(layers, CompiledSprite());
+
+
     // Load the textures into the Textures map
     // The textures will have an index of [1: num_of_textures]
     for(const auto& entry : entries) {
@@ -77,45 +111,53 @@ void ResourceManager::LoadTextures(const std::string& path_str)
         int id = std::stoi(entry.path().stem().string()); // get the int from file name
     
         std::cout << "Loading texture id " << id << ": " << fullPath << std::endl;
-        Textures[id] = loadTextureFromFile(fullPath.c_str(), false);
+        Textures.insert_or_assign(id, loadTextureFromFile(fullPath.c_str(), false)); // no default texture is created first
     
     }
 
+    // One palette for all the textures, so any texel can be drawn next to any other
+    if(indexed) {
+        ColorPalette.Build(Arena.Data(), Arena.UsedTexels());
+        Arena.Quantize(ColorPalette);
+    }
 
 }
 
 
-Texture2D ResourceManager::GetTexture(int index)
+unsigned int ResourceManager::AllocateLayer()
 {
-    return Textures[index];
+    return Arena.Reserve();
 }
 
-void ResourceManager::LoadCharacter(unsigned char c, Character character ) 
+void ResourceManager::UpdateLayer(unsigned int layer, const std::vector<unsigned char>& rgba)
 {
-    Characters.insert(std::pair<char, Character>(c, character));
+    Arena.Write(layer, rgba);
+    TextureLayers.SetLayer(layer, rgba.data());
+    CompiledSprites[layer].Compile(rgba.data(), Arena.Size);
 }
 
-Character ResourceManager::GetCharacter(unsigned char c) 
+TextureHandle ResourceManager::GetTexture(int index)
 {
-
-    // Based on the type of char passed, finds the matching character
-    auto it = Characters.find(c);
-    if (it == Characters.end()) {
-        std::cerr << "ERROR::ResourceManager: Character '" << c << "' not found!" << std::endl;
-        throw std::runtime_error("Character not found in ResourceManager");
+    // operator[] would insert an empty texture for an unknown id
+    auto it = Textures.find(index);
+    if(it == Textures.end()) {
+        std::cerr << "ERROR::ResourceManager: Texture " << index << " not found!" << std::endl;
+        throw std::runtime_error("Texture not found in ResourceManager");
     }
-    // return the character
-    return it->second;
+    // The map nodes never move, so the handle stays valid until Clear
+    return TextureHandle(it->second);
 }
 
 void ResourceManager::Clear()
 {
-    // (properly) delete all shaders	
-    for (auto iter : Shaders)
-        glDeleteProgram(iter.second.ID);
-    // (properly) delete all textures
-    for (auto iter : Textures)
-        glDeleteTextures(1, &iter.second.ID);
+    // (properly) delete all shaders and textures, each one deletes its GL object
+    ShaderList.clear();
+    ShaderNames.clear();
+    Textures.clear();
+    TextureLayers.Release();
+    // release the cpu-side texels
+    Arena.Clear();
+    CompiledSprites.clear();
 }
 
 Shader ResourceManager::loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile)
@@ -180,8 +222,13 @@ Texture2D ResourceManager::loadTextureFromFile(const char *file, bool alpha)
     unsigned char* data = stbi_load(file, &width, &height, &nrChannels, 0);
     if(data) {
         
-        // Save image on the cpu-side buffer
-        texture.PixelBuffer.assign(data, data + width * height * nrChannels);
+        // Save a normalized copy of the image in the cpu-side arena and in the matching texture layer
+        std::vector<unsigned char> rgba = Arena.Normalize(data, width, height, nrChannels);
+        texture.Layer = Arena.Store(rgba);
+        texture.ArenaOffset = Arena.SlotOffset(texture.Layer);
+        TextureLayers.SetLayer(texture.Layer, rgba.data());
+        // Any texture can be used as a sprite, so all of them get their posts
+        CompiledSprites[texture.Layer].Compile(rgba.data(), Arena.Size);
 
         // now generate texture
         texture.Generate(width, height, data);
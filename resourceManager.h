@@ -1,41 +1,63 @@
 #ifndef RESOURCE_MANAGER_H
 #define RESOURCE_MANAGER_H
 
+#include <deque>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "glad/glad.h"
 
 #include "texture.h"
+#include "texelArena.h"
+#include "textureArray.h"
+#include "compiledSprite.h"
 #include "shader.h"
-#include "character.h"
+
+// Index of a shader in ResourceManager::ShaderList
+typedef unsigned int ShaderHandle;
 
 
 // A static singleton ResourceManager class that hosts several
 // functions to load Textures and Shaders. Each loaded texture
-// and/or shader is also stored for future reference by string
-// handles. All functions and resources are static and no 
-// public constructor is defined.
+// is stored for future reference by its number, and each shader
+// by a small integer handle (its slot in a dense array) that is
+// resolved from its name once. The GL objects of the resources are
+// owned by them and deleted by Clear. All functions and resources are
+// static and no public constructor is defined.
 class ResourceManager
 {
 public:
     // resource storage
-    static std::map<std::string, Shader>    Shaders;
+    static std::deque<Shader>               ShaderList; // a deque keeps the renderers' references valid while it grows
+    static std::map<std::string, ShaderHandle> ShaderNames;
     static std::map<int, Texture2D> Textures;
-    static std::map<GLchar, Character> Characters;
+    // CPU-side texels of every loaded texture (RGBA8, same power-of-two size)
+    static TexelArena Arena;
+    // Palette shared by the textures when they are loaded indexed (the arena keeps an index per texel)
+    static Palette ColorPalette;
+    // GPU copy of the arena, one array layer per texture (used by the sprite batches)
+    static TextureArray TextureLayers;
+    // Opaque bounds and column posts of every texture, indexed by layer (used by the sprites)
+    static std::vector<CompiledSprite> CompiledSprites;
 
     // loads (and generates) a shader program from file loading vertex, fragment (and geometry) shader's source code. If gShaderFile is not nullptr, it also loads a geometry shader
-    static Shader    LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name);
-    // retrieves a stored sader
-    static Shader    GetShader(std::string name);
-    // loads texture from /Textures* directory
-    static void LoadTextures(const std::string& path_str);
-    // retrieves a stored texture
-    static Texture2D GetTexture(int index);
-    // loads an instance of character
-    static void LoadCharacter(unsigned char c, Character character);
-    // retrieves an instance of character
-    static Character GetCharacter(unsigned char c);
+    // Returns the handle of the shader (loading a name again replaces the shader in the same slot)
+    static ShaderHandle LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, const std::string& name);
+    // retrieves the handle of a shader by its name (for loading code and tools, not for the frame loop)
+    static ShaderHandle FindShader(const std::string& name);
+    // retrieves a stored shader, without copying it
+    static Shader&   GetShader(ShaderHandle handle) { return ShaderList[handle]; }
+    // loads texture from /Textures* directory, keeping the CPU-side texels in the arena with the given layout
+    // spareLayers extra arena slots / array layers are kept for textures built at runtime
+    // indexed also quantizes every texture to ColorPalette, built from all of them
+    static void LoadTextures(const std::string& path_str, TexelLayout layout = TEXEL_ROW_MAJOR, unsigned int spareLayers = 0, bool indexed = false);
+    // takes one of the spare layers
+    static unsigned int AllocateLayer();
+    // replaces the content of a layer (arena, texture array and compiled sprite) with a normalized RGBA image
+    static void UpdateLayer(unsigned int layer, const std::vector<unsigned char>& rgba);
+    // retrieves a handle to a stored texture (the texture itself stays in Textures), throws if it was not loaded
+    static TextureHandle GetTexture(int index);
     
     // properly de-allocates all loaded resources
     static void      Clear();
@@ -1,11 +1,12 @@
 
 #include "shader.h"
+#include "glState.h"
 #include <iostream>
 
 
 Shader &Shader::Use() {
 
-    glUseProgram(this->ID);
+    GLState::UseProgram(this->Program.ID());
     return *this; 
 }
 
@@ -34,19 +35,45 @@ void Shader::Compile(const char* vertexSource, const char* fragmentSource, const
         }
 
         // shader Program
-        this->ID = glCreateProgram();
-        glAttachShader(this->ID, vertex);
-        glAttachShader(this->ID, fragment);
+        this->Program.Reset(); // compiling again replaces the previous program
+        GLuint program = this->Program.Get();
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
         if (geometrySource != nullptr)
-            glAttachShader(this->ID, geometry);
-        glLinkProgram(this->ID);
-        CheckCompileErrors(this->ID, "PROGRAM");
+            glAttachShader(program, geometry);
+        glLinkProgram(program);
+        CheckCompileErrors(program, "PROGRAM");
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
         if (geometrySource != nullptr)
             glDeleteShader(geometry);
 
+        // Resolve the location of every active uniform once, the setters only read this table
+        this->locations.clear();
+        GLint uniformCount = 0, nameLength = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &nameLength);
+        std::vector<GLchar> uniformName(nameLength > 0 ? nameLength : 1);
+        for(GLint i = 0; i < uniformCount; i++) {
+            GLint size;
+            GLenum type;
+            glGetActiveUniform(program, i, uniformName.size(), nullptr, &size, &type, uniformName.data());
+            std::string name(uniformName.data());
+            // Arrays are reported as "name[0]", they are set by their plain name
+            if(name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+                name.resize(name.size() - 3);
+            // Members of uniform blocks have no location
+            GLint location = glGetUniformLocation(program, name.c_str());
+            if(location >= 0)
+                this->locations[name] = location;
+        }
+
+        // The shared per-frame uniforms are read from the buffer bound on FRAME_UNIFORM_BINDING
+        GLuint frameBlock = glGetUniformBlockIndex(program, "Frame");
+        if(frameBlock != GL_INVALID_INDEX)
+            glUniformBlockBinding(program, frameBlock, FRAME_UNIFORM_BINDING);
+
 }
 // utility uniform functions
 // ------------------------------------------------------------------------
@@ -54,88 +81,138 @@ void Shader::SetBool(const std::string &name, bool value, bool useShader)
 {   
     if (useShader)
         this->Use();
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+    GLState::CountUniform();
+    glUniform1i(this->Location(name), (int)value); 
 }
 // ------------------------------------------------------------------------
 void Shader::SetInt(const std::string &name, int value, bool useShader) 
 { 
     if (useShader)
         this->Use();
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+    GLState::CountUniform();
+    glUniform1i(this->Location(name), value); 
 }
 // ------------------------------------------------------------------------
 void Shader::SetFloat(const std::string &name, float value, bool useShader) 
 { 
     if (useShader)
         this->Use();
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+    GLState::CountUniform();
+    glUniform1f(this->Location(name), value); 
 }
 // ------------------------------------------------------------------------
 void Shader::SetVec1(const std::string &name, const float *value, unsigned int count, bool useShader) 
 { 
     if (useShader)
         this->Use();
-    glUniform1fv(glGetUniformLocation(ID, name.c_str()), count, value); 
+    GLState::CountUniform();
+    glUniform1fv(this->Location(name), count, value); 
 }
 // ------------------------------------------------------------------------
 void Shader::SetVec2(const std::string &name, const glm::vec2 &value, bool useShader) 
 { 
     if (useShader)
         this->Use();
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    GLState::CountUniform();
+    glUniform2fv(this->Location(name), 1, &value[0]); 
 }
 void Shader::SetVec2(const std::string &name, float x, float y,bool useShader) 
 { 
     if (useShader)
         this->Use();
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y); 
+    GLState::CountUniform();
+    glUniform2f(this->Location(name), x, y); 
 }
 // ------------------------------------------------------------------------
 void Shader::SetVec3(const std::string &name, const glm::vec3 &value, bool useShader) 
 { 
     if (useShader)
         this->Use();
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    GLState::CountUniform();
+    glUniform3fv(this->Location(name), 1, &value[0]); 
 }
 void Shader::SetVec3(const std::string &name, float x, float y, float z, bool useShader) 
 { 
     if (useShader)
         this->Use();
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); 
+    GLState::CountUniform();
+    glUniform3f(this->Location(name), x, y, z); 
 }
 // ------------------------------------------------------------------------
 void Shader::SetVec4(const std::string &name, const glm::vec4 &value, bool useShader) 
 { 
     if (useShader)
         this->Use();
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    GLState::CountUniform();
+    glUniform4fv(this->Location(name), 1, &value[0]); 
 }
 void Shader::SetVec4(const std::string &name, float x, float y, float z, float w, bool useShader) 
 { 
     if (useShader)
         this->Use();
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w); 
+    GLState::CountUniform();
+    glUniform4f(this->Location(name), x, y, z, w); 
 }
 // ------------------------------------------------------------------------
 void Shader::SetMat2(const std::string &name, const glm::mat2 &mat, bool useShader) 
 {
     if (useShader)
         this->Use();
-    glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    GLState::CountUniform();
+    glUniformMatrix2fv(this->Location(name), 1, GL_FALSE, &mat[0][0]);
 }
 // ------------------------------------------------------------------------
 void Shader::SetMat3(const std::string &name, const glm::mat3 &mat, bool useShader) 
 {
     if (useShader)
         this->Use();
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    GLState::CountUniform();
+    glUniformMatrix3fv(this->Location(name), 1, GL_FALSE, &mat[0][0]);
 }
 // ------------------------------------------------------------------------
 void Shader::SetMat4(const std::string &name, const glm::mat4 &mat, bool useShader) 
 {
     if (useShader)
         this->Use();
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    GLState::CountUniform();
+    glUniformMatrix4fv(this->Location(name), 1, GL_FALSE, &mat[0][0]);
+}
+
+GLint Shader::Location(const std::string &name) const
+{
+    auto it = this->locations.find(name);
+    // -1 makes glUniform ignore the call, like glGetUniformLocation does for unknown names
+    return it != this->locations.end() ? it->second : -1;
+}
+// ------------------------------------------------------------------------
+void Shader::SetInt(GLint location, int value)
+{
+    GLState::CountUniform();
+    glUniform1i(location, value);
+}
+// ------------------------------------------------------------------------
+void Shader::SetFloat(GLint location, float value)
+{
+    GLState::CountUniform();
+    glUniform1f(location, value);
+}
+// ------------------------------------------------------------------------
+void Shader::SetVec3(GLint location, const glm::vec3 &value)
+{
+    GLState::CountUniform();
+    glUniform3fv(location, 1, &value[0]);
+}
+// ------------------------------------------------------------------------
+void Shader::SetVec4(GLint location, const glm::vec4 &value)
+{
+    GLState::CountUniform();
+    glUniform4fv(location, 1, &value[0]);
+}
+// ------------------------------------------------------------------------
+void Shader::SetMat4(GLint location, const glm::mat4 &mat)
+{
+    GLState::CountUniform();
+    glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::CheckCompileErrors(GLuint shader, std::string type)
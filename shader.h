@@ -4,16 +4,27 @@
 
 #include "glad/glad.h"
 #include "glm/glm.hpp"
+#include "glObject.h"
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+// Binding point of the "Frame" uniform block (see FrameUniforms)
+const GLuint FRAME_UNIFORM_BINDING = 0;
+
+// The Shader owns its program, so it can be moved but not copied: the
+// renderers keep a reference to the one stored in the ResourceManager.
 class Shader
 {
 public:
-    unsigned int ID;
+    // owns the program object
+    GLProgram Program;
+    // GL name of the program (0 until Compile is called)
+    unsigned int ID() const { return this->Program.ID(); }
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
     Shader(){ }
@@ -47,8 +58,19 @@ public:
     void SetMat3(const std::string &name, const glm::mat3 &mat, bool useShader = false);
     // ------------------------------------------------------------------------
     void SetMat4(const std::string &name, const glm::mat4 &mat, bool useShader = false);
+    // uniform handles: the location is looked up once (by name, after linking),
+    // then the hot paths set the value with a single glUniform call
+    // ------------------------------------------------------------------------
+    GLint Location(const std::string &name) const;
+    void SetInt(GLint location, int value);
+    void SetFloat(GLint location, float value);
+    void SetVec3(GLint location, const glm::vec3 &value);
+    void SetVec4(GLint location, const glm::vec4 &value);
+    void SetMat4(GLint location, const glm::mat4 &mat);
 
 private:
+    // location of each active uniform, filled when the program is linked
+    std::unordered_map<std::string, GLint> locations;
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void CheckCompileErrors(GLuint shader, std::string type);
@@ -0,0 +1,169 @@
+#include "softwareRenderer.h"
+#include "floorProjection.h"
+#include "glState.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+
+// Copies an arena texel (alpha is always 255 there)
+static inline void putTexel(unsigned char* pixel, const unsigned char* texel)
+{
+    std::memcpy(pixel, texel, 4);
+}
+
+// Copies an arena texel at half brightness (the 0.5 tints of the shaders)
+static inline void putShadedTexel(unsigned char* pixel, const unsigned char* texel)
+{
+    pixel[0] = texel[0] >> 1;
+    pixel[1] = texel[1] >> 1;
+    pixel[2] = texel[2] >> 1;
+    pixel[3] = 255;
+}
+
+
+SoftwareRenderer::SoftwareRenderer(unsigned int width, unsigned int height, ThreadPool* pool, const Palette* palette)
+    : Width(width), Height(height), Pixels(width * height * (palette ? 1 : 4), 0), IndexPalette(palette), Columns(width), pool(pool),
+      image(palette ? GL_R8 : GL_RGBA, palette ? GL_RED : GL_RGBA, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_NEAREST, GL_NEAREST),
+      paletteImage(GL_RGB, GL_RGB, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_NEAREST, GL_NEAREST)
+{
+    // The palette never changes, it is uploaded once.
+    // Rows of indices (and of palette colors) are not 4-byte aligned
+    if(palette) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        this->paletteImage.Generate(PALETTE_COLORS, 1, const_cast<unsigned char*>(&palette->Colors[0][0]));
+    }
+
+    // Same distances as the GL floor casting, taken at the pixel centers
+    // so the horizon rows never divide by zero
+    this->rowDistance.resize(height);
+    for(unsigned int y = 0; y < height; y++)
+        this->rowDistance[y] = FloorRowDistance(height, y + 0.5f);
+}
+
+void SoftwareRenderer::DrawScene(const GameLevel& level, glm::vec2 position, const TexelArena& arena, const SoftwareSky& sky)
+{
+    unsigned int strips = (this->Width + SOFTWARE_STRIP - 1) / SOFTWARE_STRIP;
+
+    // Every column is independent, so each strip belongs to one thread without any locking
+    this->pool->ParallelFor(strips, [&](unsigned int strip) {
+        unsigned int begin = strip * SOFTWARE_STRIP;
+        unsigned int end = std::min(begin + SOFTWARE_STRIP, this->Width);
+        if(this->Indexed()) this->drawStrip<true>(begin, end, level, position, arena, sky);
+        else                this->drawStrip<false>(begin, end, level, position, arena, sky);
+    });
+}
+
+template <bool Indexed>
+void SoftwareRenderer::drawStrip(unsigned int begin, unsigned int end, const GameLevel& level, glm::vec2 position,
+                                 const TexelArena& arena, const SoftwareSky& sky)
+{
+    const unsigned int pixelBytes = Indexed ? 1 : 4;
+    const unsigned int rowBytes = this->Width * pixelBytes;
+    const unsigned char* texels = arena.Data();
+    // Half brightness of each index (the 0.5 tints of the shaders)
+    const unsigned char* halfShade = Indexed ? this->IndexPalette->ColorMap[PALETTE_HALF_SHADE] : nullptr;
+
+    // Writers of the texel at a byte offset of the arena
+    auto put = [&](unsigned char* pixel, size_t texel) {
+        if constexpr (Indexed) *pixel = arena.Index(texel);
+        else                   putTexel(pixel, texels + texel);
+    };
+    auto putShaded = [&](unsigned char* pixel, size_t texel) {
+        if constexpr (Indexed) *pixel = halfShade[arena.Index(texel)];
+        else                   putShadedTexel(pixel, texels + texel);
+    };
+    const int mapWidth = static_cast<int>(level.tileData[0].size());
+    const int mapHeight = static_cast<int>(level.tileData.size());
+    const float skyRows = this->Height / 2.0f;
+    assert(!sky.Enabled || sky.Texels != SIZE_MAX);
+
+    // Rows of the wall (pixel centers inside the slice) and texel column of the sky, per column
+    int wallTop[SOFTWARE_STRIP], wallBottom[SOFTWARE_STRIP];
+    unsigned int skyTexX[SOFTWARE_STRIP];
+    for(unsigned int x = begin; x < end; x++) {
+        const SoftwareColumn& column = this->Columns[x];
+        assert(column.WallTexels != SIZE_MAX);
+        wallTop[x - begin] = std::clamp(static_cast<int>(std::ceil(column.WallStart - 0.5f)), 0, static_cast<int>(this->Height));
+        wallBottom[x - begin] = std::clamp(static_cast<int>(std::ceil(column.WallEnd - 0.5f)), 0, static_cast<int>(this->Height));
+
+        // The sky wraps around the player (GL_REPEAT in the shader)
+        float u = sky.Offset + ((x + 0.5f) / this->Width - 0.5f) * sky.Span;
+        skyTexX[x - begin] = static_cast<unsigned int>(static_cast<int>(std::floor(u * arena.Size))) & arena.Mask;
+    }
+
+    for(unsigned int y = 0; y < this->Height; y++) {
+        unsigned char* pixel = &this->Pixels[y * rowBytes + begin * pixelBytes];
+        float distance = this->rowDistance[y];
+        bool ceiling = y < this->Height / 2;
+
+        for(unsigned int x = begin; x < end; x++, pixel += pixelBytes) {
+            const SoftwareColumn& column = this->Columns[x];
+            int i = x - begin;
+
+            // =============== WALL ==================
+            if(static_cast<int>(y) >= wallTop[i] && static_cast<int>(y) < wallBottom[i]) {
+                float v = (y + 0.5f - column.WallStart) / (column.WallEnd - column.WallStart);
+                unsigned int texY = std::min(static_cast<unsigned int>(v * arena.Size), arena.Mask);
+                size_t texel = column.WallTexels + arena.TexelOffset(column.WallTexX, texY);
+                if(column.Shaded) putShaded(pixel, texel);
+                else              put(pixel, texel);
+                continue;
+            }
+
+            // =============== FLOOR AND CEILING ==================
+            // Point of the floor (or ceiling) seen by the pixel, in map cells
+            glm::vec2 floor = position + distance * column.RayDir;
+            int cellX = static_cast<int>(floor.x);
+            int cellY = static_cast<int>(floor.y);
+
+            // Outside the map stays black
+            if(floor.x < 0.0f || floor.y < 0.0f || cellX >= mapWidth || cellY >= mapHeight) {
+                if constexpr (Indexed) {
+                    *pixel = PALETTE_BLACK;
+                }
+                else {
+                    pixel[0] = pixel[1] = pixel[2] = 0;
+                    pixel[3] = 255;
+                }
+                continue;
+            }
+
+            // The sky shows through the open ceiling cells
+            if(ceiling && sky.Enabled && level.ceilingData[cellY][cellX] == SKY_CELL) {
+                unsigned int texY = static_cast<unsigned int>((y + 0.5f) / skyRows * arena.Size) & arena.Mask;
+                put(pixel, sky.Texels + arena.TexelOffset(skyTexX[i], texY));
+                continue;
+            }
+
+            // Bitmasks, the arena size is a power of two
+            unsigned int texX = static_cast<unsigned int>(arena.Size * (floor.x - cellX)) & arena.Mask;
+            unsigned int texY = static_cast<unsigned int>(arena.Size * (floor.y - cellY)) & arena.Mask;
+
+            int cell = cellY * mapWidth + cellX;
+            size_t surface = ceiling ? level.ceilingTexels[cell] : level.floorTexels[cell];
+            assert(surface != SIZE_MAX);
+            putShaded(pixel, surface + arena.TexelOffset(texX, texY));
+        }
+    }
+}
+
+void SoftwareRenderer::Present(SpriteRenderer& renderer, glm::vec2 position)
+{
+    // Calls Generate only once, then only the texels are replaced
+    if(!this->image.IsInitialized)
+        this->image.Generate(this->Width, this->Height, this->Pixels.data());
+    else
+        this->image.Update(this->Pixels.data());
+
+    // The palette shader reads the colors of the indices from the second unit
+    if(this->Indexed()) {
+        GLState::ActiveTexture(GL_TEXTURE1);
+        this->paletteImage.Bind();
+        GLState::ActiveTexture(GL_TEXTURE0);
+    }
+
+    renderer.DrawSprite(TextureHandle(this->image), position, glm::vec2(this->Width, this->Height), 0.0f, glm::vec3(1.0f));
+}
@@ -0,0 +1,91 @@
+#ifndef SOFTWARE_RENDERER_H
+#define SOFTWARE_RENDERER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "gameLevel.h"
+#include "palette.h"
+#include "spriteRenderer.h"
+#include "texelArena.h"
+#include "texture.h"
+#include "threadPool.h"
+
+// Width (in pixels) of the column strips handed to each thread
+const unsigned int SOFTWARE_STRIP = 16;
+
+// What the wall casting found for one screen column
+struct SoftwareColumn
+{
+    glm::vec2 RayDir;        // Direction of the ray (not normalized, same as the wall casting)
+    float WallStart;         // Screen rows covered by the wall slice (not clipped to the screen)
+    float WallEnd;
+    size_t WallTexels;       // Arena offset of the wall texture
+    unsigned int WallTexX;   // Texel column of the wall texture
+    bool Shaded;             // Hit on a y side: drawn at half brightness
+};
+
+// Sky seen through the open ceiling cells (same mapping as the sky shader)
+struct SoftwareSky
+{
+    bool Enabled = false;
+    size_t Texels = 0;       // Arena offset of the sky texture
+    float Offset = 0.0f;     // Texture u at the center of the view
+    float Span = 0.0f;       // Texture u covered by the whole view (negative flips it)
+};
+
+// CPU backend of the 3D view. The sky, the ceiling, the walls and the
+// floor of every column are composed into one RGBA framebuffer, the
+// sprites are rasterized over it, and the result reaches the screen with a
+// single texture upload and one quad, instead of a draw per wall slice.
+// The columns come from the same ray casting as the GL path (RayCasting
+// fills Columns); the texels come from the arena, with the same tints as
+// the shaders. Strips of SOFTWARE_STRIP columns are shared by the threads
+// of the pool and each row of a strip is written left to right.
+//
+// With a palette the framebuffer is indexed: one byte per pixel copied from
+// the palette indices of the arena, the shading goes through the palette
+// color map, and the upload is a single-channel texture that the palette
+// shader expands to RGB. That is a quarter of the bytes written per pixel
+// and uploaded per frame.
+class SoftwareRenderer
+{
+public:
+    // Size of the framebuffer (the 3D view)
+    unsigned int Width, Height;
+    // RGBA pixels (or palette indices when indexed), row-major, first row at the top of the screen
+    std::vector<unsigned char> Pixels;
+    // Palette of the indexed framebuffer (nullptr for RGBA)
+    const Palette* IndexPalette;
+    // One entry per screen column, filled by the wall casting
+    std::vector<SoftwareColumn> Columns;
+
+    // The framebuffer is indexed with palette when it is given (the arena must be quantized to it)
+    SoftwareRenderer(unsigned int width, unsigned int height, ThreadPool* pool, const Palette* palette = nullptr);
+
+    bool Indexed() const { return this->IndexPalette != nullptr; }
+
+    // Composes the sky, ceiling, walls and floor of the columns.
+    // position is the player in map cells
+    void DrawScene(const GameLevel& level, glm::vec2 position, const TexelArena& arena, const SoftwareSky& sky);
+    // Uploads the framebuffer and draws it as one quad at position (screen pixels)
+    // An indexed framebuffer needs a renderer with the palette shader (the palette goes on texture unit 1)
+    void Present(SpriteRenderer& renderer, glm::vec2 position);
+
+private:
+    ThreadPool* pool;
+    // Distance from the camera to the floor (or ceiling) seen by each row
+    std::vector<float> rowDistance;
+    // The framebuffer on the GPU, and the palette as a 256 x 1 texture when indexed
+    Texture2D image;
+    Texture2D paletteImage;
+
+    // Composes the columns [begin, end), as RGBA or as palette indices
+    template <bool Indexed>
+    void drawStrip(unsigned int begin, unsigned int end, const GameLevel& level, glm::vec2 position,
+                   const TexelArena& arena, const SoftwareSky& sky);
+};
+
+#endif
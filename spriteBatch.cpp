@@ -0,0 +1,147 @@
+#include "spriteBatch.h"
+#include "glState.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+
+SpriteBatch::SpriteBatch()
+{
+    GLState::BindVertexArray(this->vertexArray.Get());
+    glBindBuffer(GL_ARRAY_BUFFER, this->vertexBuffer.Get());
+
+    GLsizei stride = sizeof(BatchVertex);
+    glEnableVertexAttribArray(0); // Position
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(BatchVertex, Position));
+    glEnableVertexAttribArray(1); // Texture coordinates
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(BatchVertex, TexCoords));
+    glEnableVertexAttribArray(2); // Color
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(BatchVertex, Color));
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::BindVertexArray(0);
+}
+
+void SpriteBatch::Begin()
+{
+    // Whatever was drawn before keeps its place
+    this->flush();
+    this->batching = true;
+}
+
+void SpriteBatch::End()
+{
+    this->flush();
+    this->batching = false;
+}
+
+void SpriteBatch::Draw(Shader &shader, const TextureHandle &texture, glm::vec2 position, glm::vec2 size,
+                       float rotate, glm::vec3 color, glm::vec2 pivot, glm::vec4 uv)
+{
+    // Corners of the unit quad, as (x, y) on the screen and on the texture: two triangles
+    static const float corners[SPRITE_BATCH_QUAD_VERTICES][2] = {
+        {0.0f, 1.0f}, {1.0f, 0.0f}, {0.0f, 0.0f},
+        {0.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, 0.0f}
+    };
+
+    Quad quad;
+    quad.Key = (static_cast<uint64_t>(shader.ID()) << 32) | texture.ID;
+    quad.Program = &shader;
+    quad.Texture = texture.ID;
+    quad.First = this->vertices.size();
+    this->quads.push_back(quad);
+
+    size_t first = this->vertices.size();
+    this->vertices.resize(first + SPRITE_BATCH_QUAD_VERTICES);
+    BatchVertex* out = &this->vertices[first];
+
+    if(rotate == 0.0f) {
+        // Fast path: the corners are the rectangle itself
+        for(unsigned int i = 0; i < SPRITE_BATCH_QUAD_VERTICES; i++) {
+            float x = corners[i][0], y = corners[i][1];
+            out[i].Position = glm::vec2(position.x + x * size.x, position.y + y * size.y);
+            out[i].TexCoords = glm::vec2(uv.x + x * (uv.z - uv.x), uv.y + y * (uv.w - uv.y));
+            out[i].Color = color;
+        }
+    }
+    else {
+        // Each corner is rotated around the pivot (same rotation as glm::rotate around z)
+        float angle = glm::radians(rotate);
+        float c = std::cos(angle), s = std::sin(angle);
+        glm::vec2 center = position + pivot * size;
+        for(unsigned int i = 0; i < SPRITE_BATCH_QUAD_VERTICES; i++) {
+            float x = corners[i][0], y = corners[i][1];
+            glm::vec2 local = (glm::vec2(x, y) - pivot) * size;
+            out[i].Position = center + glm::vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+            out[i].TexCoords = glm::vec2(uv.x + x * (uv.z - uv.x), uv.y + y * (uv.w - uv.y));
+            out[i].Color = color;
+        }
+    }
+
+    // Outside Begin/End the quad is drawn now
+    if(!this->batching)
+        this->flush();
+}
+
+void SpriteBatch::flush()
+{
+    if(this->quads.empty()) return;
+
+    // Equal shaders and textures end up next to each other, in the order they came
+    const std::vector<BatchVertex>* source = &this->vertices;
+    if(this->quads.size() > 1) {
+        std::stable_sort(this->quads.begin(), this->quads.end(),
+                         [](const Quad& a, const Quad& b) { return a.Key < b.Key; });
+
+        this->upload.resize(this->vertices.size());
+        for(size_t i = 0; i < this->quads.size(); i++)
+            std::copy_n(&this->vertices[this->quads[i].First], SPRITE_BATCH_QUAD_VERTICES, &this->upload[i * SPRITE_BATCH_QUAD_VERTICES]);
+        source = &this->upload;
+    }
+
+    // Streaming upload: each flush is appended after the previous one, so the draws still reading
+    // the buffer are never overwritten. Only when the buffer is full is its storage orphaned
+    // (GL hands out a fresh one and frees the old one when those draws are done).
+    size_t count = source->size();
+    glBindBuffer(GL_ARRAY_BUFFER, this->vertexBuffer.ID());
+    if(count > this->capacity) {
+        this->capacity = std::max(count * 2, SPRITE_BATCH_MIN_VERTICES);
+        this->cursor = this->capacity; // Forces the allocation below
+    }
+    if(this->cursor + count > this->capacity) {
+        glBufferData(GL_ARRAY_BUFFER, this->capacity * sizeof(BatchVertex), nullptr, GL_STREAM_DRAW);
+        this->vertexBuffer.SetBytes(this->capacity * sizeof(BatchVertex));
+        this->cursor = 0;
+    }
+    // Nothing in flight uses the range after the cursor, so the driver does not have to synchronize
+    void* range = glMapBufferRange(GL_ARRAY_BUFFER, this->cursor * sizeof(BatchVertex), count * sizeof(BatchVertex),
+                                   GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    std::copy_n(source->data(), count, static_cast<BatchVertex*>(range));
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    size_t base = this->cursor;
+    this->cursor += count;
+
+    GLState::BindVertexArray(this->vertexArray.ID());
+    GLState::ActiveTexture(GL_TEXTURE0);
+
+    // One draw call per run of quads with the same shader and texture
+    this->LastQuads = this->quads.size();
+    this->LastDraws = 0;
+    size_t run = 0;
+    while(run < this->quads.size()) {
+        size_t end = run + 1;
+        while(end < this->quads.size() && this->quads[end].Key == this->quads[run].Key) end++;
+
+        this->quads[run].Program->Use();
+        GLState::BindTexture(GL_TEXTURE_2D, this->quads[run].Texture);
+        GLState::DrawArrays(GL_TRIANGLES, base + run * SPRITE_BATCH_QUAD_VERTICES, (end - run) * SPRITE_BATCH_QUAD_VERTICES);
+        this->LastDraws++;
+        run = end;
+    }
+
+    this->quads.clear();
+    this->vertices.clear();
+}
@@ -0,0 +1,77 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <cstdint>
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "texture.h"
+#include "shader.h"
+#include "glObject.h"
+
+// One corner of a batched quad, laid out exactly as the vertex buffer
+// (attributes 0, 1 and 2 of shaderCoordinate.vs)
+struct BatchVertex {
+    glm::vec2 Position;  // Screen position in pixels
+    glm::vec2 TexCoords;
+    glm::vec3 Color;     // Tint
+};
+
+// Vertices of each quad (two triangles)
+const unsigned int SPRITE_BATCH_QUAD_VERTICES = 6;
+// Smallest vertex buffer, enough for a few frames of walls and minimap before it wraps
+const size_t SPRITE_BATCH_MIN_VERTICES = 16384;
+
+// Collects 2D quads with their final screen vertices and draws them with
+// as few draw calls as possible. Between Begin and End the quads are only
+// stored; End sorts them by shader and texture (keeping the order of the
+// quads that share both) and draws each run of equal ones with a single
+// draw call from a streaming vertex buffer. Outside Begin/End every quad
+// is drawn right away, in the order it comes.
+//
+// Sorting changes the order of the quads, so only the quads that do not
+// overlap (or whose order does not matter) go inside the same Begin/End.
+class SpriteBatch
+{
+public:
+    SpriteBatch();
+
+    // Starts keeping the quads
+    void Begin();
+    // Sorts and draws the quads kept since Begin
+    void End();
+
+    // Adds a quad of the given size at position, rotated (degrees) around the pivot
+    // (relative to the size). uv is the texture rectangle (u0, v0, u1, v1).
+    void Draw(Shader &shader, const TextureHandle &texture, glm::vec2 position, glm::vec2 size,
+              float rotate, glm::vec3 color, glm::vec2 pivot = glm::vec2(0.5f), glm::vec4 uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+
+    // Quads and draw calls of the last flush
+    unsigned int LastQuads = 0, LastDraws = 0;
+
+private:
+    // A stored quad: what it needs bound and where its vertices are
+    struct Quad {
+        uint64_t Key;       // Shader in the high bits, texture in the low bits
+        Shader*  Program;
+        GLuint   Texture;
+        unsigned int First; // Index of its first vertex in vertices
+    };
+
+    std::vector<BatchVertex> vertices; // In the order the quads came
+    std::vector<Quad>        quads;
+    std::vector<BatchVertex> upload;   // Vertices in the drawing order
+    bool batching = false;
+
+    GLVertexArray vertexArray;
+    GLBuffer      vertexBuffer;
+    size_t        capacity = 0; // Vertices the buffer can hold
+    size_t        cursor = 0;   // First free vertex, the next flush is written there
+
+    // Draws the stored quads and forgets them
+    void flush();
+};
+
+#endif
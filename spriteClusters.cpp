@@ -0,0 +1,173 @@
+#include "spriteClusters.h"
+#include "resourceManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+
+
+void SpriteClusters::Build(const std::vector<GameObject>& elements, float tileSize)
+{
+    this->Clusters.clear();
+    this->SpriteCluster.assign(elements.size(), 0);
+
+    // One cluster per block of SPRITE_CLUSTER_CELLS x SPRITE_CLUSTER_CELLS cells
+    std::map<std::pair<int, int>, unsigned int> blocks;
+    for(unsigned int i = 0; i < elements.size(); i++) {
+        glm::vec2 cell = elements[i].Position / tileSize;
+        std::pair<int, int> block(static_cast<int>(std::floor(cell.x / SPRITE_CLUSTER_CELLS)),
+                                  static_cast<int>(std::floor(cell.y / SPRITE_CLUSTER_CELLS)));
+
+        auto it = blocks.find(block);
+        if(it == blocks.end()) {
+            it = blocks.insert(std::make_pair(block, this->Clusters.size())).first;
+            this->Clusters.push_back(Cluster());
+            this->Clusters.back().Center = glm::vec2(0.0f);
+        }
+
+        Cluster& cluster = this->Clusters[it->second];
+        cluster.Sprites.push_back(i);
+        cluster.Center += cell;
+        this->SpriteCluster[i] = it->second;
+    }
+
+    for(Cluster& cluster : this->Clusters)
+        cluster.Center /= static_cast<float>(cluster.Sprites.size());
+
+    // The spare layers are only taken once, a new level reuses them
+    if(this->layers.empty()) {
+        for(unsigned int i = 0; i < SPRITE_IMPOSTOR_LAYERS; i++)
+            this->layers.push_back(ResourceManager::AllocateLayer());
+    }
+    this->freeLayers = this->layers;
+}
+
+bool SpriteClusters::UseImpostor(unsigned int index, glm::vec2 playerCell, glm::vec2 direction, glm::vec2 plane,
+                                 const std::vector<GameObject>& elements, float tileSize, float spriteWidth, unsigned int frame)
+{
+    Cluster& cluster = this->Clusters[index];
+
+    // A single sprite is already as cheap as it gets
+    if(cluster.Sprites.size() < 2) return false;
+
+    // Close clusters go back to individual sprites
+    float distance = glm::length(playerCell - cluster.Center);
+    float threshold = cluster.Layer >= 0 ? SPRITE_IMPOSTOR_DISTANCE - SPRITE_IMPOSTOR_HYSTERESIS : SPRITE_IMPOSTOR_DISTANCE;
+    if(distance <= threshold) {
+        if(cluster.Layer >= 0) {
+            this->freeLayers.push_back(cluster.Layer);
+            cluster.Layer = -1;
+        }
+        return false;
+    }
+
+    float angle = std::atan2(direction.y, direction.x);
+
+    if(cluster.Layer < 0) {
+        cluster.Layer = this->acquireLayer(frame);
+        if(cluster.Layer < 0) return false; // Every layer is in use in this frame
+        this->compose(cluster, direction, plane, elements, tileSize, spriteWidth);
+        cluster.Angle = angle;
+    }
+    else if(std::abs(std::remainder(angle - cluster.Angle, 2.0f * static_cast<float>(M_PI))) > SPRITE_IMPOSTOR_ANGLE) {
+        // The view turned too much since the last composition
+        this->compose(cluster, direction, plane, elements, tileSize, spriteWidth);
+        cluster.Angle = angle;
+    }
+
+    cluster.LastFrame = frame;
+    return true;
+}
+
+int SpriteClusters::acquireLayer(unsigned int frame)
+{
+    if(!this->freeLayers.empty()) {
+        int layer = this->freeLayers.back();
+        this->freeLayers.pop_back();
+        return layer;
+    }
+
+    // Steals the layer of the impostor that has not been drawn for the longest time
+    Cluster* oldest = nullptr;
+    for(Cluster& cluster : this->Clusters) {
+        if(cluster.Layer >= 0 && cluster.LastFrame != frame && (!oldest || cluster.LastFrame < oldest->LastFrame))
+            oldest = &cluster;
+    }
+    if(!oldest) return -1;
+
+    int layer = oldest->Layer;
+    oldest->Layer = -1;
+    return layer;
+}
+
+void SpriteClusters::compose(Cluster& cluster, glm::vec2 direction, glm::vec2 plane,
+                             const std::vector<GameObject>& elements, float tileSize, float spriteWidth)
+{
+    const TexelArena& arena = ResourceManager::Arena;
+    const unsigned int size = arena.Size;
+
+    // Same camera transform as the sprite casting, relative to the cluster center
+    // x = position along the camera plane, y = depth
+    float invDet = 1.0f / (plane.x * direction.y - direction.x * plane.y);
+
+    std::vector<Member>& members = this->members;
+    members.clear();
+    float minLateral = 0.0f, maxLateral = 0.0f;
+    float depthRange = 0.0f;
+
+    for(unsigned int n = 0; n < cluster.Sprites.size(); n++) {
+        glm::vec2 offset = elements[cluster.Sprites[n]].Position / tileSize - cluster.Center;
+        float lateral = invDet * (direction.y * offset.x - direction.x * offset.y);
+        float depth = invDet * (-plane.y * offset.x + plane.x * offset.y);
+
+        members.push_back(Member{depth, lateral, cluster.Sprites[n]});
+        minLateral = n == 0 ? lateral : std::min(minLateral, lateral);
+        maxLateral = n == 0 ? lateral : std::max(maxLateral, lateral);
+        depthRange = std::max(depthRange, std::abs(depth));
+    }
+
+    cluster.Offset = (minLateral + maxLateral) / 2.0f;
+    cluster.Width = maxLateral - minLateral + spriteWidth;
+    // Never 0, the instance uses it to tell the impostors from the plain sprites
+    cluster.DepthRange = std::max(depthRange, 0.01f);
+
+    // Farthest first, the near sprites are painted over them
+    std::sort(members.begin(), members.end(), [](const Member& a, const Member& b) { return a.Depth > b.Depth; });
+
+    // Every sprite keeps the whole height of the image, only the horizontal axis is shared.
+    // Black texels stay transparent, like in the sprites themselves
+    std::vector<unsigned char>& image = this->image;
+    image.assign(arena.TextureBytes(), 0);
+    float columnsPerSprite = spriteWidth / cluster.Width * size;
+
+    for(const Member& member : members) {
+        const GameObject& sprite = elements[member.Id];
+        // The alpha of each texel keeps the depth of the sprite drawn there, from -DepthRange (0) to +DepthRange (255),
+        // so the walls hide each sprite of the impostor at its own depth
+        unsigned char depth = static_cast<unsigned char>(std::lround((member.Depth / cluster.DepthRange + 1.0f) * 127.5f));
+        const unsigned char* texels = arena.Data() + arena.SlotOffset(sprite.Sprite->Layer);
+
+        // The image starts half a sprite before the leftmost sprite center
+        float left = (member.Lateral - minLateral) / cluster.Width * size;
+        int firstX = std::max(static_cast<int>(std::ceil(left - 0.5f)), 0);
+        int lastX = std::min(static_cast<int>(std::ceil(left + columnsPerSprite - 0.5f)), static_cast<int>(size));
+
+        for(int x = firstX; x < lastX; x++) {
+            unsigned int texX = static_cast<unsigned int>((x + 0.5f - left) / columnsPerSprite * size) & arena.Mask;
+
+            for(unsigned int y = 0; y < size; y++) {
+                const unsigned char* texel = texels + arena.TexelOffset(texX, y);
+                if((texel[0] | texel[1] | texel[2]) == 0) continue;
+
+                unsigned char* pixel = &image[(y * size + x) * 4];
+                pixel[0] = static_cast<unsigned char>(std::min(texel[0] * sprite.Color.r, 255.0f));
+                pixel[1] = static_cast<unsigned char>(std::min(texel[1] * sprite.Color.g, 255.0f));
+                pixel[2] = static_cast<unsigned char>(std::min(texel[2] * sprite.Color.b, 255.0f));
+                pixel[3] = depth;
+            }
+        }
+    }
+
+    ResourceManager::UpdateLayer(cluster.Layer, image);
+}
@@ -0,0 +1,79 @@
+#ifndef SPRITE_CLUSTERS_H
+#define SPRITE_CLUSTERS_H
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "gameObject.h"
+
+// Side (in map cells) of the square blocks that group the sprites into clusters
+const unsigned int SPRITE_CLUSTER_CELLS = 4;
+// Distance (in map cells) from which a cluster is drawn as a single impostor
+const float SPRITE_IMPOSTOR_DISTANCE = 8.0f;
+// An impostor only goes back to individual sprites this much closer, so it does not flicker on the border
+const float SPRITE_IMPOSTOR_HYSTERESIS = 1.0f;
+// View rotation (radians) after which an impostor is composed again (~10 degrees)
+const float SPRITE_IMPOSTOR_ANGLE = 0.1745f;
+// Texture layers kept for the impostors. Clusters without a free layer are drawn sprite by sprite
+const unsigned int SPRITE_IMPOSTOR_LAYERS = 32;
+
+// Level of detail for the static sprites.
+// The sprites are grouped by blocks of the map. When a whole cluster is far
+// from the player, its sprites are composed (on the CPU) into one image that
+// is drawn as a single wide sprite: one entry to sort, project and draw
+// instead of one per sprite. The composition uses the camera orientation of
+// the moment, so it is refreshed when the view turns more than SPRITE_IMPOSTOR_ANGLE.
+class SpriteClusters
+{
+public:
+    struct Cluster {
+        std::vector<unsigned int> Sprites; // Ids inside GameLevel::elementsInfo
+        glm::vec2 Center;                  // Average sprite position (map cells)
+        int Layer = -1;                    // Texture layer of the impostor, -1 when drawn sprite by sprite
+        float Angle = 0.0f;                // View angle used to compose the impostor
+        float Offset = 0.0f;               // Center of the impostor along the camera plane, relative to Center (plane units)
+        float Width = 0.0f;                // Width of the impostor (plane units)
+        float DepthRange = 0.0f;           // Largest distance (depth units) of a sprite in front of or behind Center
+        unsigned int LastFrame = 0;        // Last frame in which the impostor was drawn
+    };
+
+    std::vector<Cluster> Clusters;
+    // Cluster of each sprite
+    std::vector<unsigned int> SpriteCluster;
+
+    SpriteClusters() { }
+
+    // Groups the elements (positions in map pixels, tileSize pixels per cell) and takes the spare texture layers
+    void Build(const std::vector<GameObject>& elements, float tileSize);
+
+    // Decides if a cluster is drawn as an impostor for a player at playerCell, and (re)composes
+    // its image when needed. Returns true when the impostor must be drawn instead of the sprites.
+    // Only called for clusters whose sprites were all gathered in this frame, the impostor always shows all of them
+    // spriteWidth is the width of one sprite in camera plane units, frame identifies the current frame
+    bool UseImpostor(unsigned int cluster, glm::vec2 playerCell, glm::vec2 direction, glm::vec2 plane,
+                     const std::vector<GameObject>& elements, float tileSize, float spriteWidth, unsigned int frame);
+
+private:
+    // Texture layers taken for the impostors, and the ones not used by any cluster
+    std::vector<unsigned int> layers;
+    std::vector<unsigned int> freeLayers;
+
+    // Sprite of the cluster as seen from the camera during a composition
+    struct Member {
+        float Depth, Lateral;
+        unsigned int Id;
+    };
+    // Storage of the compositions, kept between them so composing does not allocate
+    std::vector<Member> members;
+    std::vector<unsigned char> image;
+
+    // Gets a layer for a new impostor, taking it from the impostor unused for the longest time if needed
+    int acquireLayer(unsigned int frame);
+
+    // Composes the sprites of a cluster, seen from the current camera orientation
+    void compose(Cluster& cluster, glm::vec2 direction, glm::vec2 plane,
+                 const std::vector<GameObject>& elements, float tileSize, float spriteWidth);
+};
+
+#endif
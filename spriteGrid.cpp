@@ -0,0 +1,35 @@
+#include "spriteGrid.h"
+
+#include <algorithm>
+
+
+void SpriteGrid::Build(const std::vector<GameObject>& elements, unsigned int mapWidth, unsigned int mapHeight, float tileSize)
+{
+    this->Width = mapWidth;
+    this->Height = mapHeight;
+
+    unsigned int cells = mapWidth * mapHeight;
+    this->cellStart.assign(cells + 1, 0);
+    this->cellSprites.resize(elements.size());
+
+    // Cell of each sprite. Elements placed outside the map go to the closest border cell
+    std::vector<unsigned int> spriteCell(elements.size());
+    for(unsigned int i = 0; i < elements.size(); i++) {
+        int x = static_cast<int>(elements[i].Position.x / tileSize);
+        int y = static_cast<int>(elements[i].Position.y / tileSize);
+        x = std::clamp(x, 0, static_cast<int>(mapWidth) - 1);
+        y = std::clamp(y, 0, static_cast<int>(mapHeight) - 1);
+
+        spriteCell[i] = this->CellIndex(x, y);
+        this->cellStart[spriteCell[i] + 1]++;
+    }
+
+    // Counts -> starting slots
+    for(unsigned int c = 0; c < cells; c++)
+        this->cellStart[c + 1] += this->cellStart[c];
+
+    // Fill the buckets, the ids stay in increasing order inside each cell
+    std::vector<unsigned int> next(this->cellStart.begin(), this->cellStart.end() - 1);
+    for(unsigned int i = 0; i < elements.size(); i++)
+        this->cellSprites[next[spriteCell[i]]++] = i;
+}
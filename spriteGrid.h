@@ -0,0 +1,35 @@
+#ifndef SPRITE_GRID_H
+#define SPRITE_GRID_H
+
+#include <vector>
+
+#include "gameObject.h"
+
+// Spatial index of the level sprites, one bucket per map cell.
+// The buckets are packed one after the other (compressed rows): the sprites
+// of the cell c are the ids from cellSprites[cellStart[c]] to cellSprites[cellStart[c + 1] - 1].
+// The sprites never move, so the index is built once when the level is loaded.
+class SpriteGrid
+{
+public:
+    // Map size in cells
+    unsigned int Width = 0, Height = 0;
+
+    SpriteGrid() { }
+
+    // Buckets each element in the cell that holds its position
+    void Build(const std::vector<GameObject>& elements, unsigned int mapWidth, unsigned int mapHeight, float tileSize);
+
+    // Range of sprite ids (indexes of GameLevel::elementsInfo) inside a cell
+    const unsigned int* CellBegin(unsigned int cell) const { return this->cellSprites.data() + this->cellStart[cell]; }
+    const unsigned int* CellEnd(unsigned int cell) const { return this->cellSprites.data() + this->cellStart[cell + 1]; }
+
+    // Cell index of a map coordinate
+    unsigned int CellIndex(unsigned int x, unsigned int y) const { return y * this->Width + x; }
+
+private:
+    std::vector<unsigned int> cellStart;   // First slot of each cell (Width * Height + 1 entries)
+    std::vector<unsigned int> cellSprites; // Sprite ids grouped by cell
+};
+
+#endif
@@ -0,0 +1,83 @@
+#include "spriteInstanceRenderer.h"
+#include "glState.h"
+
+#include <cstddef>
+
+
+SpriteInstanceRenderer::SpriteInstanceRenderer(Shader &shader)
+    : shader(shader), instanceCapacity(0)
+{
+    this->initRenderData();
+}
+
+SpriteInstanceRenderer::~SpriteInstanceRenderer()
+{
+    // The buffers are deleted with their owners
+}
+
+void SpriteInstanceRenderer::initRenderData()
+{
+    // Same unit quad of the SpriteRenderer
+    float vertices[] = { 
+        // pos      // tex
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.0f, 
+    
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f
+    };
+
+    GLState::BindVertexArray(this->quadVAO.Get());
+
+    // quad attribute
+    glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO.Get());
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    this->quadVBO.SetBytes(sizeof(vertices));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+
+    // instance attributes - advance once per sprite
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO.Get());
+    GLsizei stride = sizeof(SpriteInstance);
+    glEnableVertexAttribArray(1); // Position + Size
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteInstance, Position));
+    glEnableVertexAttribArray(2); // UV rectangle
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteInstance, UV));
+    glEnableVertexAttribArray(3); // Depth + Layer + DepthRange
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteInstance, Depth));
+    glEnableVertexAttribArray(4); // Color
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteInstance, Color));
+    for(unsigned int attribute = 1; attribute <= 4; attribute++)
+        glVertexAttribDivisor(attribute, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::BindVertexArray(0);
+}
+
+void SpriteInstanceRenderer::DrawSprites(const TextureArray &textures, const DepthTexture &depth, const std::vector<SpriteInstance> &instances)
+{
+    if(instances.empty()) return;
+
+    // Upload the instances, the buffer only grows
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO.ID());
+    if(instances.size() > this->instanceCapacity) {
+        this->instanceCapacity = instances.size() * 2;
+        glBufferData(GL_ARRAY_BUFFER, this->instanceCapacity * sizeof(SpriteInstance), nullptr, GL_STREAM_DRAW);
+        this->instanceVBO.SetBytes(this->instanceCapacity * sizeof(SpriteInstance));
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(SpriteInstance), instances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    this->shader.Use();
+
+    // The wall depth goes on the second texture unit
+    GLState::ActiveTexture(GL_TEXTURE1);
+    depth.Bind();
+    GLState::ActiveTexture(GL_TEXTURE0);
+    textures.Bind();
+
+    GLState::BindVertexArray(this->quadVAO.ID());
+    GLState::DrawArraysInstanced(GL_TRIANGLES, 0, 6, instances.size());
+}
@@ -0,0 +1,48 @@
+#ifndef SPRITE_INSTANCE_RENDERER_H
+#define SPRITE_INSTANCE_RENDERER_H
+
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "textureArray.h"
+#include "depthTexture.h"
+#include "shader.h"
+#include "glObject.h"
+
+// Per-instance data of a sprite, laid out exactly as the instance vertex buffer
+struct SpriteInstance {
+    glm::vec2 Position; // Top-left corner on the screen
+    glm::vec2 Size;     // Width and height on the screen
+    glm::vec4 UV;       // Texture rectangle (u0, v0, u1, v1) covered by the quad
+    float     Depth;    // Camera-space depth, tested against the ZBuffer
+    float     Layer;    // Texture layer inside ResourceManager::TextureLayers
+    float     DepthRange; // Impostors only: depth spread of their sprites, kept per texel in the alpha (0 for a sprite)
+    glm::vec3 Color;    // Tint
+};
+
+// Draws a whole list of sprites with a single instanced draw call.
+// The instances are drawn in the order of the list, so a far-to-near
+// list keeps the painter's order of the sprites.
+class SpriteInstanceRenderer
+{
+    public:
+        SpriteInstanceRenderer(Shader &shader);
+
+        ~SpriteInstanceRenderer();
+
+        // Draws the instances with their textures, tested against the wall depth of each column
+        void DrawSprites(const TextureArray &textures, const DepthTexture &depth, const std::vector<SpriteInstance> &instances);
+
+    private:
+        Shader       &shader; // Stored in the ResourceManager
+        GLVertexArray quadVAO;
+        GLBuffer     quadVBO;
+        GLBuffer     instanceVBO;
+        size_t       instanceCapacity; // Number of instances the instance buffer can hold
+
+        void initRenderData();
+};
+
+#endif
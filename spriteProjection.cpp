@@ -0,0 +1,162 @@
+#include "spriteProjection.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Sprites projected together by the vector kernel
+const unsigned int SPRITE_PROJECTION_LANES = 4;
+// Sprite sizes are clamped before the conversion to int (a sprite right on the camera plane is infinite)
+const float SPRITE_PROJECTION_MAX_SIZE = 16777216.0f;
+
+
+void SpriteProjection::Resize(unsigned int count)
+{
+    this->Count = count;
+    if(count <= this->X.size()) return;
+
+    for(std::vector<float>* array : {&this->X, &this->Y, &this->WidthScale, &this->U0, &this->V0, &this->U1, &this->V1,
+                                     &this->Distance, &this->Depth, &this->StartX, &this->StartY, &this->EndX, &this->EndY,
+                                     &this->ClipU0, &this->ClipU1})
+        array->resize(count, 0.0f);
+    this->Visible.resize(count, 0);
+}
+
+void SpriteProjection::Project(const SpriteCamera& camera)
+{
+#if defined(__SSE2__)
+    this->projectSSE2(camera);
+#else
+    this->projectScalar(0, camera);
+#endif
+}
+
+// Same steps as the vector kernel, one sprite at a time
+void SpriteProjection::projectScalar(unsigned int begin, const SpriteCamera& camera)
+{
+    // Same for every sprite
+    //transform sprite with the inverse camera matrix
+    // [ planeX   dirX ] -1                                       [ dirY      -dirX ]
+    // [               ]       =  1/(planeX*dirY-dirX*planeY) *   [                 ]
+    // [ planeY   dirY ]                                          [ -planeY  planeX ]
+    float invDet = 1.0f / (camera.Plane.x * camera.Direction.y - camera.Direction.x * camera.Plane.y);
+    int halfHeight = static_cast<int>(camera.Height) / 2;
+    float quarterWidth = static_cast<float>(static_cast<int>(camera.Width) / 4);
+    float viewStart = static_cast<float>(static_cast<int>(camera.Width) / 2);
+
+    for(unsigned int i = begin; i < this->Count; i++) {
+
+        // Translate sprite position to relative to camera
+        float dx = this->X[i] - camera.Position.x;
+        float dy = this->Y[i] - camera.Position.y;
+        this->Distance[i] = dx * dx + dy * dy;
+
+        float transformX = invDet * (camera.Direction.y * dx - camera.Direction.x * dy);
+        float transformY = invDet * (-camera.Plane.y * dx + camera.Plane.x * dy);
+        this->Depth[i] = transformY;
+
+        // If the sprite is behind the player it is not drawn
+        if(transformY <= 0) { this->Visible[i] = 0; continue; }
+
+        // Screen center and size (the width is divided by 4 because we use only half of the screen)
+        int screenX = static_cast<int>(quarterWidth * (1 + transformX / transformY) + viewStart);
+        int spriteHeight = std::abs(static_cast<int>(std::min(camera.Height / transformY, SPRITE_PROJECTION_MAX_SIZE)));
+        int spriteWidth = std::abs(static_cast<int>(std::min(camera.Height / transformY * this->WidthScale[i], SPRITE_PROJECTION_MAX_SIZE)));
+
+        // Full quad of the texture
+        float fullStartX = -spriteWidth / 2 + screenX;
+        float fullSizeX = (spriteWidth / 2 + screenX) - fullStartX;
+        float fullStartY = -spriteHeight / 2 + halfHeight;
+        float fullSizeY = (spriteHeight / 2 + halfHeight) - fullStartY;
+
+        // Tight bounds, then the horizontal clamp to the 3D view
+        float startX = std::max(fullStartX + this->U0[i] * fullSizeX, viewStart);
+        float endX = std::min(fullStartX + this->U1[i] * fullSizeX, camera.Width);
+
+        this->StartX[i] = startX;
+        this->EndX[i] = endX;
+        this->StartY[i] = fullStartY + this->V0[i] * fullSizeY;
+        this->EndY[i] = fullStartY + this->V1[i] * fullSizeY;
+        this->ClipU0[i] = (startX - fullStartX) / fullSizeX;
+        this->ClipU1[i] = (endX - fullStartX) / fullSizeX;
+
+        // Nothing left on the screen after the clamping
+        this->Visible[i] = endX > startX;
+    }
+}
+
+#if defined(__SSE2__)
+void SpriteProjection::projectSSE2(const SpriteCamera& camera)
+{
+    float invDet = 1.0f / (camera.Plane.x * camera.Direction.y - camera.Direction.x * camera.Plane.y);
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 playerX = _mm_set1_ps(camera.Position.x);
+    const __m128 playerY = _mm_set1_ps(camera.Position.y);
+    const __m128 dirX = _mm_set1_ps(camera.Direction.x);
+    const __m128 dirY = _mm_set1_ps(camera.Direction.y);
+    const __m128 planeX = _mm_set1_ps(camera.Plane.x);
+    const __m128 planeY = _mm_set1_ps(camera.Plane.y);
+    const __m128 det = _mm_set1_ps(invDet);
+    const __m128 quarterWidth = _mm_set1_ps(static_cast<float>(static_cast<int>(camera.Width) / 4));
+    const __m128 height = _mm_set1_ps(camera.Height);
+    const __m128 maxSize = _mm_set1_ps(SPRITE_PROJECTION_MAX_SIZE);
+    const __m128 viewStart = _mm_set1_ps(static_cast<float>(static_cast<int>(camera.Width) / 2));
+    const __m128 viewEnd = _mm_set1_ps(camera.Width);
+    const __m128i halfHeight = _mm_set1_epi32(static_cast<int>(camera.Height) / 2);
+
+    unsigned int vectorCount = this->Count / SPRITE_PROJECTION_LANES * SPRITE_PROJECTION_LANES;
+
+    for(unsigned int i = 0; i < vectorCount; i += SPRITE_PROJECTION_LANES) {
+
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(&this->X[i]), playerX);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(&this->Y[i]), playerY);
+        _mm_storeu_ps(&this->Distance[i], _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+
+        __m128 transformX = _mm_mul_ps(det, _mm_sub_ps(_mm_mul_ps(dirY, dx), _mm_mul_ps(dirX, dy)));
+        __m128 transformY = _mm_mul_ps(det, _mm_add_ps(_mm_mul_ps(_mm_sub_ps(zero, planeY), dx), _mm_mul_ps(planeX, dy)));
+        _mm_storeu_ps(&this->Depth[i], transformY);
+
+        // Lanes behind the camera divide by 1 instead, their results are masked out at the end
+        __m128 inFront = _mm_cmpgt_ps(transformY, zero);
+        __m128 safeY = _mm_or_ps(_mm_and_ps(inFront, transformY), _mm_andnot_ps(inFront, one));
+
+        // Screen center and size, truncated like the scalar casts
+        __m128i screenX = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(quarterWidth, _mm_add_ps(one, _mm_div_ps(transformX, safeY))), viewStart));
+        __m128 size = _mm_div_ps(height, safeY);
+        __m128i spriteHeight = _mm_cvttps_epi32(_mm_min_ps(size, maxSize));
+        __m128i spriteWidth = _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(size, _mm_loadu_ps(&this->WidthScale[i])), maxSize));
+
+        // Sizes are positive in front of the camera, so the division by 2 is a shift
+        __m128i halfW = _mm_srai_epi32(spriteWidth, 1);
+        __m128i halfH = _mm_srai_epi32(spriteHeight, 1);
+
+        __m128 fullStartX = _mm_cvtepi32_ps(_mm_sub_epi32(screenX, halfW));
+        __m128 fullSizeX = _mm_sub_ps(_mm_cvtepi32_ps(_mm_add_epi32(screenX, halfW)), fullStartX);
+        __m128 fullStartY = _mm_cvtepi32_ps(_mm_sub_epi32(halfHeight, halfH));
+        __m128 fullSizeY = _mm_sub_ps(_mm_cvtepi32_ps(_mm_add_epi32(halfHeight, halfH)), fullStartY);
+
+        // Tight bounds, then the horizontal clamp to the 3D view
+        __m128 startX = _mm_max_ps(_mm_add_ps(fullStartX, _mm_mul_ps(_mm_loadu_ps(&this->U0[i]), fullSizeX)), viewStart);
+        __m128 endX = _mm_min_ps(_mm_add_ps(fullStartX, _mm_mul_ps(_mm_loadu_ps(&this->U1[i]), fullSizeX)), viewEnd);
+
+        _mm_storeu_ps(&this->StartX[i], startX);
+        _mm_storeu_ps(&this->EndX[i], endX);
+        _mm_storeu_ps(&this->StartY[i], _mm_add_ps(fullStartY, _mm_mul_ps(_mm_loadu_ps(&this->V0[i]), fullSizeY)));
+        _mm_storeu_ps(&this->EndY[i], _mm_add_ps(fullStartY, _mm_mul_ps(_mm_loadu_ps(&this->V1[i]), fullSizeY)));
+        _mm_storeu_ps(&this->ClipU0[i], _mm_div_ps(_mm_sub_ps(startX, fullStartX), fullSizeX));
+        _mm_storeu_ps(&this->ClipU1[i], _mm_div_ps(_mm_sub_ps(endX, fullStartX), fullSizeX));
+
+        // Visible = in front of the camera and something left after the clamping (all bits set -> 1)
+        __m128 visible = _mm_and_ps(inFront, _mm_cmpgt_ps(endX, startX));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&this->Visible[i]), _mm_srli_epi32(_mm_castps_si128(visible), 31));
+    }
+
+    // Last sprites that do not fill a group
+    this->projectScalar(vectorCount, camera);
+}
+#endif
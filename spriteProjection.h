@@ -0,0 +1,55 @@
+#ifndef SPRITE_PROJECTION_H
+#define SPRITE_PROJECTION_H
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// Camera values shared by every sprite of the frame
+struct SpriteCamera {
+    glm::vec2 Position;  // Player position (map cells)
+    glm::vec2 Direction;
+    glm::vec2 Plane;
+    float Width, Height; // Screen size (the 3D view is the right half)
+};
+
+// Batch of sprites projected to the screen, stored as structure of arrays so
+// the whole batch runs through the same transform 4 sprites at a time (SSE2,
+// with a plain scalar loop on other targets).
+// Fill the input arrays of the first Count entries, call Project, then read
+// the output arrays of the entries marked as Visible.
+class SpriteProjection
+{
+public:
+    // Number of sprites in the batch
+    unsigned int Count = 0;
+
+    // ===== Inputs =====
+    std::vector<float> X, Y;           // Sprite position (map cells)
+    std::vector<float> WidthScale;     // Width in sprites (1 for a sprite, more for an impostor)
+    std::vector<float> U0, V0, U1, V1; // Texture rectangle drawn (tight bounds), all zero for an empty sprite
+
+    // ===== Outputs =====
+    std::vector<float> Distance;       // Squared distance to the player (map cells)
+    std::vector<float> Depth;          // Camera-space depth (the TransformY)
+    std::vector<float> StartX, StartY; // Top-left corner of the clipped quad on the screen
+    std::vector<float> EndX, EndY;     // Bottom-right corner of the clipped quad on the screen
+    std::vector<float> ClipU0, ClipU1; // Horizontal texture range left after the screen clipping
+    std::vector<int>   Visible;        // In front of the camera and inside the 3D view
+
+    SpriteProjection() { }
+
+    // Sets the number of sprites, the storage only grows
+    void Resize(unsigned int count);
+
+    // Projects the whole batch
+    void Project(const SpriteCamera& camera);
+
+private:
+    void projectScalar(unsigned int begin, const SpriteCamera& camera);
+#if defined(__SSE2__)
+    void projectSSE2(const SpriteCamera& camera);
+#endif
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "spriteRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+SpriteRasterizer::SpriteRasterizer(unsigned int width, unsigned int height, ThreadPool* pool)
+    : Width(width), Height(height), Pixels(width * height * 4, 0), pool(pool)
+{
+
+}
+
+void SpriteRasterizer::DrawSprites(const std::vector<SpriteInstance>& instances, const std::vector<float>& zBuffer,
+                                   const TexelArena& arena, const std::vector<CompiledSprite>& shapes, float viewX)
+{
+    unsigned int strips = (this->Width + SPRITE_RASTER_STRIP - 1) / SPRITE_RASTER_STRIP;
+
+    // Each strip of columns belongs to one thread, so the sprites keep their
+    // far to near order inside every column without any locking
+    this->pool->ParallelFor(strips, [&](unsigned int strip) {
+        unsigned int begin = strip * SPRITE_RASTER_STRIP;
+        unsigned int end = std::min(begin + SPRITE_RASTER_STRIP, this->Width);
+        this->drawStrip(this->Pixels.data(), true, begin, end, instances, zBuffer, arena, shapes, viewX, nullptr);
+    });
+}
+
+void SpriteRasterizer::DrawSpritesOver(std::vector<unsigned char>& target, const std::vector<SpriteInstance>& instances,
+                                       const std::vector<float>& zBuffer, const TexelArena& arena,
+                                       const std::vector<CompiledSprite>& shapes, float viewX, const Palette* palette)
+{
+    unsigned int strips = (this->Width + SPRITE_RASTER_STRIP - 1) / SPRITE_RASTER_STRIP;
+
+    this->pool->ParallelFor(strips, [&](unsigned int strip) {
+        unsigned int begin = strip * SPRITE_RASTER_STRIP;
+        unsigned int end = std::min(begin + SPRITE_RASTER_STRIP, this->Width);
+        this->drawStrip(target.data(), false, begin, end, instances, zBuffer, arena, shapes, viewX, palette);
+    });
+}
+
+void SpriteRasterizer::drawStrip(unsigned char* target, bool clear, unsigned int begin, unsigned int end,
+                                 const std::vector<SpriteInstance>& instances, const std::vector<float>& zBuffer,
+                                 const TexelArena& arena, const std::vector<CompiledSprite>& shapes, float viewX,
+                                 const Palette* palette)
+{
+    const unsigned int pixelBytes = palette ? 1 : 4;
+    const unsigned int rowBytes = this->Width * pixelBytes;
+
+    // Clear the strip (transparent)
+    if(clear) {
+        for(unsigned int y = 0; y < this->Height; y++)
+            std::memset(&target[y * rowBytes + begin * pixelBytes], 0, (end - begin) * pixelBytes);
+    }
+
+    const unsigned char* texels = arena.Data();
+
+    for(const SpriteInstance& sprite : instances) {
+
+        // Columns of the sprite inside the strip (pixel centers inside the quad)
+        float left = sprite.Position.x - viewX;
+        float right = left + sprite.Size.x;
+        int firstX = std::max(static_cast<int>(std::ceil(left - 0.5f)), static_cast<int>(begin));
+        int lastX = std::min(static_cast<int>(std::ceil(right - 0.5f)), static_cast<int>(end));
+        if(firstX >= lastX) continue;
+
+        unsigned int layer = static_cast<unsigned int>(sprite.Layer);
+        const CompiledSprite& shape = shapes[layer];
+        size_t spriteOffset = arena.SlotOffset(layer);
+        const unsigned char* spriteTexels = texels + spriteOffset;
+
+        // Texture steps per screen pixel
+        float uStep = (sprite.UV.z - sprite.UV.x) / sprite.Size.x;
+        // Screen rows per texel row, and the row where the whole texture would start
+        float rowsPerTexel = sprite.Size.y / ((sprite.UV.w - sprite.UV.y) * arena.Size);
+        float textureTop = sprite.Position.y - sprite.UV.y * arena.Size * rowsPerTexel;
+
+        // Tint in fixed point (0 - 256)
+        int tintR = static_cast<int>(sprite.Color.r * 256.0f);
+        int tintG = static_cast<int>(sprite.Color.g * 256.0f);
+        int tintB = static_cast<int>(sprite.Color.b * 256.0f);
+        // Untinted sprites copy the indices, the tinted ones look up the nearest index of their color
+        bool tinted = tintR != 256 || tintG != 256 || tintB != 256;
+
+        for(int x = firstX; x < lastX; x++) {
+
+            // Column-level rejection: the wall is in front of the sprite (of the nearest sprite of an impostor)
+            if(sprite.Depth - sprite.DepthRange > zBuffer[x]) continue;
+            // Impostors keep the depth of each of their sprites in the alpha, so they are tested texel by texel
+            bool perTexel = sprite.DepthRange > 0.0f && sprite.Depth + sprite.DepthRange > zBuffer[x];
+            float alphaDepth = 2.0f * sprite.DepthRange / 255.0f; // Depth of one alpha step
+
+            float u = sprite.UV.x + (x + 0.5f - left) * uStep;
+            unsigned int texX = static_cast<unsigned int>(u * arena.Size) & arena.Mask;
+
+            // Only the opaque runs of the column, the transparent texels are never read
+            for(const SpritePost* post = shape.ColumnBegin(texX); post != shape.ColumnEnd(texX); post++) {
+
+                // Screen rows whose centers fall inside the post, clipped to the screen
+                int firstY = static_cast<int>(std::ceil(textureTop + post->Top * rowsPerTexel - 0.5f));
+                int lastY = static_cast<int>(std::ceil(textureTop + (post->Top + post->Length) * rowsPerTexel - 0.5f));
+                firstY = std::max(firstY, 0);
+                lastY = std::min(lastY, static_cast<int>(this->Height));
+                // The post is all above or below the screen (the row pointer would be outside the framebuffer)
+                if(firstY >= lastY) continue;
+
+                unsigned char* pixel = &target[firstY * rowBytes + x * pixelBytes];
+
+                for(int y = firstY; y < lastY; y++, pixel += rowBytes) {
+                    // Rounding can land one row outside the post, so the row is clamped into it
+                    int texY = static_cast<int>((y + 0.5f - textureTop) / rowsPerTexel);
+                    texY = std::clamp(texY, static_cast<int>(post->Top), post->Top + post->Length - 1);
+                    size_t texelOffset = arena.TexelOffset(texX, texY);
+                    const unsigned char* texel = spriteTexels + texelOffset;
+                    if(perTexel && sprite.Depth - sprite.DepthRange + texel[3] * alphaDepth > zBuffer[x]) continue;
+
+                    if(palette) {
+                        if(!tinted) *pixel = arena.Index(spriteOffset + texelOffset);
+                        else        *pixel = palette->Nearest(std::min((texel[0] * tintR) >> 8, 255),
+                                                              std::min((texel[1] * tintG) >> 8, 255),
+                                                              std::min((texel[2] * tintB) >> 8, 255));
+                        continue;
+                    }
+
+                    pixel[0] = std::min((texel[0] * tintR) >> 8, 255);
+                    pixel[1] = std::min((texel[1] * tintG) >> 8, 255);
+                    pixel[2] = std::min((texel[2] * tintB) >> 8, 255);
+                    pixel[3] = 255;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef SPRITE_RASTERIZER_H
+#define SPRITE_RASTERIZER_H
+
+#include <vector>
+
+#include "spriteInstanceRenderer.h"
+#include "compiledSprite.h"
+#include "texelArena.h"
+#include "threadPool.h"
+
+// Width (in pixels) of the column strips handed to each thread.
+// Wide strips keep the writes of each thread mostly inside its own part of every row
+const unsigned int SPRITE_RASTER_STRIP = 16;
+
+// Draws the sprites on the CPU, column by column, into an RGBA framebuffer
+// with the size of the 3D view. Each column is tested once against the wall
+// distance in the ZBuffer: if the sprite is behind the wall, the whole column
+// is skipped, so sprites hidden behind walls cost almost nothing. Inside a
+// column only the opaque posts of the compiled sprite are drawn.
+// The pixels that no sprite covers are left transparent, so the buffer can be
+// drawn over the walls as a single quad.
+class SpriteRasterizer
+{
+public:
+    // Size of the framebuffer (the 3D view)
+    unsigned int Width, Height;
+    // RGBA pixels, row-major, first row at the top of the screen
+    std::vector<unsigned char> Pixels;
+
+    SpriteRasterizer(unsigned int width, unsigned int height, ThreadPool* pool);
+
+    // Draws the instances (far to near) over a cleared framebuffer.
+    // viewX is the screen x of the first column, zBuffer holds one wall distance per column
+    // shapes holds the compiled sprite of each texture layer
+    void DrawSprites(const std::vector<SpriteInstance>& instances, const std::vector<float>& zBuffer,
+                     const TexelArena& arena, const std::vector<CompiledSprite>& shapes, float viewX);
+    // Same, but over an existing framebuffer of the same size (the software renderer), which is not cleared.
+    // With a palette the target holds one palette index per pixel instead of RGBA
+    void DrawSpritesOver(std::vector<unsigned char>& target, const std::vector<SpriteInstance>& instances,
+                         const std::vector<float>& zBuffer, const TexelArena& arena,
+                         const std::vector<CompiledSprite>& shapes, float viewX, const Palette* palette = nullptr);
+
+private:
+    ThreadPool* pool;
+
+    // Draws the columns [begin, end) into target, clearing them first when clear is set
+    // The target is indexed when palette is set
+    void drawStrip(unsigned char* target, bool clear, unsigned int begin, unsigned int end,
+                   const std::vector<SpriteInstance>& instances, const std::vector<float>& zBuffer,
+                   const TexelArena& arena, const std::vector<CompiledSprite>& shapes, float viewX,
+                   const Palette* palette);
+};
+
+#endif
@@ -1,4 +1,3 @@
-
 #ifndef SPRITERENDERER_H
 #define SPRITERENDERER_H
 
@@ -7,11 +6,15 @@
 
 #include "texture.h"
 #include "shader.h"
+#include "spriteBatch.h"
 
+// Draws textured 2D quads with one shader. The quads go through the
+// shared SpriteBatch: drawn right away, or kept and drawn together
+// between Begin and End.
 class SpriteRenderer
 {
     public:
-        SpriteRenderer(Shader &shader);
+        SpriteRenderer(Shader &shader, SpriteBatch &batch);
 
         ~SpriteRenderer();
         /*
@@ -20,15 +23,21 @@ class SpriteRenderer
             glm::vec3 color = glm::vec3(1.0f));
             */
             
-void DrawSprite(Texture2D &texture, glm::vec2 position,
+void DrawSprite(const TextureHandle &texture, glm::vec2 position,
 glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f, 
-glm::vec3 color = glm::vec3(1.0f), glm::vec2 pivot = glm::vec2(0.5f, 0.5f));
+glm::vec3 color = glm::vec3(1.0f), glm::vec2 pivot = glm::vec2(0.5f, 0.5f),
+glm::vec4 uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f)); // uv = texture rectangle (u0, v0, u1, v1)
 
-    private:
-        Shader       shader; 
-        unsigned int quadVAO;
+        // Draws one wall slice: column = (screen x, top y, height, texture x), width = slice width
+        void DrawColumn(const TextureHandle &texture, glm::vec4 column, float width, glm::vec3 color);
 
-        void initRenderData();
+        // Keeps the quads drawn until End, which draws them sorted by shader and texture
+        void Begin() { this->batch.Begin(); }
+        void End() { this->batch.End(); }
+
+    private:
+        Shader       &shader; // Stored in the ResourceManager
+        SpriteBatch  &batch;  // Shared by the renderers
 };
 
-#endif
\ No newline at end of file
+#endif
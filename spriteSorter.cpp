@@ -0,0 +1,145 @@
+#include "spriteSorter.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+void SpriteSorter::Reserve(unsigned int count)
+{
+    this->previous.clear();
+    this->previous.reserve(count);
+    this->distanceById.assign(count, 0.0f);
+    this->candidateStamp.assign(count, 0);
+    this->stamp = 0;
+
+    this->keys.resize(count);
+    this->keysSwap.resize(count);
+    this->idsSwap.resize(count);
+}
+
+void SpriteSorter::Sort(std::vector<int>& ids, std::vector<float>& distances)
+{
+    unsigned int count = ids.size();
+
+    // New frame for the stamps. On the wrap around the old ones are reset
+    if(++this->stamp == 0) {
+        std::fill(this->candidateStamp.begin(), this->candidateStamp.end(), 0);
+        this->stamp = 1;
+    }
+
+    // Distances indexed by sprite, so they follow the ids while they move around
+    for(unsigned int i = 0; i < count; i++) {
+        this->distanceById[ids[i]] = distances[i];
+        this->candidateStamp[ids[i]] = this->stamp;
+    }
+
+    if(count <= SPRITE_SORT_RADIX_THRESHOLD) {
+
+        // Seed: the sprites of the last frame that are still listed keep their old order
+        // and the ones that just showed up go to the end. Each taken sprite clears its
+        // stamp so it is not taken twice
+        unsigned int seeded = 0;
+        for(int id : this->previous) {
+            if(this->candidateStamp[id] == this->stamp) {
+                this->idsSwap[seeded++] = id;
+                this->candidateStamp[id] = 0;
+            }
+        }
+        for(int id : ids) {
+            if(this->candidateStamp[id] == this->stamp) {
+                this->idsSwap[seeded++] = id;
+                this->candidateStamp[id] = 0;
+            }
+        }
+        std::memcpy(ids.data(), this->idsSwap.data(), count * sizeof(int));
+
+        if(!this->insertionSort(ids))
+            this->radixSort(ids);
+    }
+    else {
+        this->radixSort(ids);
+    }
+
+    // Distances in the new order
+    for(unsigned int i = 0; i < count; i++)
+        distances[i] = this->distanceById[ids[i]];
+
+    // Keeps the order for the next frame (fits in the reserved capacity)
+    this->previous.assign(ids.begin(), ids.end());
+}
+
+bool SpriteSorter::insertionSort(std::vector<int>& ids)
+{
+    unsigned int count = ids.size();
+    unsigned int budget = count * SPRITE_SORT_SHIFT_BUDGET;
+
+    for(unsigned int i = 1; i < count; i++) {
+        int id = ids[i];
+        float distance = this->distanceById[id];
+
+        // Farthest first: moves the nearer sprites one slot to the right
+        unsigned int j = i;
+        while(j > 0 && this->distanceById[ids[j - 1]] < distance) {
+            ids[j] = ids[j - 1];
+            j--;
+        }
+        ids[j] = id;
+
+        unsigned int shifts = i - j;
+        if(shifts > budget) return false; // The list is still a permutation, the radix sort takes it from here
+        budget -= shifts;
+    }
+
+    return true;
+}
+
+void SpriteSorter::radixSort(std::vector<int>& ids)
+{
+    unsigned int count = ids.size();
+    if(count < 2) return;
+
+    // The squared distances are never negative, so their IEEE bits sort the same way as the floats.
+    // The bits are inverted to get the farthest first
+    for(unsigned int i = 0; i < count; i++) {
+        unsigned int bits;
+        std::memcpy(&bits, &this->distanceById[ids[i]], sizeof(bits));
+        this->keys[i] = ~bits;
+    }
+
+    unsigned int* keysIn = this->keys.data();
+    unsigned int* keysOut = this->keysSwap.data();
+    int* idsIn = ids.data();
+    int* idsOut = this->idsSwap.data();
+
+    // Four stable passes of 8 bits, from the lowest byte to the highest
+    for(unsigned int shift = 0; shift < 32; shift += 8) {
+
+        unsigned int histogram[256] = {0};
+        for(unsigned int i = 0; i < count; i++)
+            histogram[(keysIn[i] >> shift) & 0xFF]++;
+
+        // Every key has the same byte: nothing moves in this pass
+        if(histogram[(keysIn[0] >> shift) & 0xFF] == count) continue;
+
+        // Counts -> starting positions
+        unsigned int offset = 0;
+        for(unsigned int b = 0; b < 256; b++) {
+            unsigned int c = histogram[b];
+            histogram[b] = offset;
+            offset += c;
+        }
+
+        for(unsigned int i = 0; i < count; i++) {
+            unsigned int slot = histogram[(keysIn[i] >> shift) & 0xFF]++;
+            keysOut[slot] = keysIn[i];
+            idsOut[slot] = idsIn[i];
+        }
+
+        std::swap(keysIn, keysOut);
+        std::swap(idsIn, idsOut);
+    }
+
+    // The result ended in the swap buffer
+    if(idsIn != ids.data())
+        std::memcpy(ids.data(), idsIn, count * sizeof(int));
+}
@@ -0,0 +1,46 @@
+#ifndef SPRITE_SORTER_H
+#define SPRITE_SORTER_H
+
+#include <vector>
+
+// Above this many sprites the ordering always goes straight to the radix sort
+const unsigned int SPRITE_SORT_RADIX_THRESHOLD = 512;
+// Insertion sort gives up (and falls back to the radix sort) after this many shifts per sprite
+const unsigned int SPRITE_SORT_SHIFT_BUDGET = 8;
+
+// Orders the sprites from the farthest to the nearest.
+// From one frame to the next the order barely changes, so the list is first
+// seeded with the order of the previous frame and fixed with an insertion sort,
+// which is close to linear when only a few sprites swap places. Big lists (or
+// frames where the order changed too much) use an LSD radix sort on the bits of
+// the squared distances instead.
+// All the storage is kept between frames: after Reserve there are no heap
+// allocations while sorting.
+class SpriteSorter
+{
+public:
+    SpriteSorter() { }
+
+    // Allocates the storage for a level with count sprites (ids from 0 to count - 1)
+    void Reserve(unsigned int count);
+
+    // Sorts the ids far to near. distances[i] is the squared distance of ids[i];
+    // both arrays are rewritten in the new order
+    void Sort(std::vector<int>& ids, std::vector<float>& distances);
+
+private:
+    std::vector<int> previous;               // Order of the last frame
+    std::vector<float> distanceById;         // Distance of each sprite in this frame
+    std::vector<unsigned int> candidateStamp; // Frame in which each sprite was last listed
+    unsigned int stamp = 0;
+
+    // Radix sort buffers
+    std::vector<unsigned int> keys, keysSwap;
+    std::vector<int> idsSwap;
+
+    // Returns false when the shift budget runs out
+    bool insertionSort(std::vector<int>& ids);
+    void radixSort(std::vector<int>& ids);
+};
+
+#endif
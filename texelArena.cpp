@@ -0,0 +1,130 @@
+#include "texelArena.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+
+TexelArena::~TexelArena()
+{
+    this->Clear();
+}
+
+void TexelArena::Allocate(unsigned int count, unsigned int size, TexelLayout layout)
+{
+    this->Clear();
+
+    if(!TexelLayoutSupported(layout, size, size)) {
+        std::cout << "WARNING::TEXEL_ARENA: layout not supported for size " << size << ", using row-major" << std::endl;
+        layout = TEXEL_ROW_MAJOR;
+    }
+
+    this->Size = size;
+    this->Mask = size - 1;
+    this->Layout = layout;
+    this->capacity = count;
+
+    // aligned_alloc needs the size to be a multiple of the alignment
+    size_t bytes = this->TextureBytes() * count;
+    bytes = (bytes + TEXEL_ARENA_ALIGNMENT - 1) / TEXEL_ARENA_ALIGNMENT * TEXEL_ARENA_ALIGNMENT;
+
+    this->data = static_cast<unsigned char*>(std::aligned_alloc(TEXEL_ARENA_ALIGNMENT, bytes));
+    if(this->data == nullptr)
+        throw std::runtime_error("Failed to allocate the texel arena");
+}
+
+std::vector<unsigned char> TexelArena::Normalize(const unsigned char* image, unsigned int width, unsigned int height, unsigned int channels) const
+{
+    // Row-major RGBA copy, resized with nearest sampling to the size class
+    std::vector<unsigned char> rgba(this->TextureBytes());
+    for(unsigned int y = 0; y < this->Size; y++) {
+        const unsigned char* row = image + static_cast<size_t>(y * height / this->Size) * width * channels;
+
+        for(unsigned int x = 0; x < this->Size; x++) {
+            const unsigned char* texel = row + static_cast<size_t>(x * width / this->Size) * channels;
+            unsigned char* out = &rgba[(y * this->Size + x) * TEXEL_ARENA_CHANNELS];
+
+            // Grey images (with or without alpha) repeat the grey value on each color
+            if(channels < 3) {
+                out[0] = out[1] = out[2] = texel[0];
+                out[3] = channels == 2 ? texel[1] : 255;
+            }
+            else {
+                out[0] = texel[0];
+                out[1] = texel[1];
+                out[2] = texel[2];
+                out[3] = channels == 4 ? texel[3] : 255;
+            }
+        }
+    }
+
+    return rgba;
+}
+
+unsigned int TexelArena::Store(const std::vector<unsigned char>& rgba)
+{
+    unsigned int slot = this->Reserve();
+    this->Write(slot, rgba);
+    return slot;
+}
+
+unsigned int TexelArena::Reserve()
+{
+    if(this->count >= this->capacity)
+        throw std::runtime_error("Texel arena is full");
+
+    return this->count++;
+}
+
+void TexelArena::Write(unsigned int slot, const std::vector<unsigned char>& rgba)
+{
+    size_t offset = this->SlotOffset(slot);
+
+    // Store it in the arena layout
+    if(this->Layout == TEXEL_ROW_MAJOR)
+        std::memcpy(this->data + offset, rgba.data(), rgba.size());
+    else {
+        std::vector<unsigned char> swizzled = SwizzleTexels(rgba.data(), this->Size, this->Size, TEXEL_ARENA_CHANNELS, this->Layout);
+        std::memcpy(this->data + offset, swizzled.data(), swizzled.size());
+    }
+
+    if(this->palette)
+        this->quantizeSlot(slot);
+}
+
+void TexelArena::Quantize(const Palette& palette)
+{
+    this->palette = &palette;
+    this->indices.assign(static_cast<size_t>(this->capacity) * this->Size * this->Size, PALETTE_BLACK);
+    for(unsigned int slot = 0; slot < this->count; slot++)
+        this->quantizeSlot(slot);
+}
+
+void TexelArena::quantizeSlot(unsigned int slot)
+{
+    // Same layout as the texels, so the offsets of one work for the other
+    size_t first = this->SlotOffset(slot) / TEXEL_ARENA_CHANNELS;
+    size_t texels = static_cast<size_t>(this->Size) * this->Size;
+    for(size_t i = first; i < first + texels; i++) {
+        const unsigned char* texel = this->data + i * TEXEL_ARENA_CHANNELS;
+        this->indices[i] = this->palette->Nearest(texel[0], texel[1], texel[2]);
+    }
+}
+
+void TexelArena::Clear()
+{
+    std::free(this->data);
+    this->data = nullptr;
+    this->indices.clear();
+    this->palette = nullptr;
+    this->capacity = 0;
+    this->count = 0;
+}
+
+unsigned int TexelArena::SizeClass(unsigned int dimension)
+{
+    unsigned int size = 1;
+    while(size < dimension) size <<= 1;
+    return size;
+}
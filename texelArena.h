@@ -0,0 +1,82 @@
+#ifndef TEXEL_ARENA_H
+#define TEXEL_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+#include "texelLayout.h"
+#include "palette.h"
+
+// Alignment of the arena storage (one cache line)
+const size_t TEXEL_ARENA_ALIGNMENT = 64;
+// Bytes per texel inside the arena (RGBA8)
+const unsigned int TEXEL_ARENA_CHANNELS = 4;
+
+// Single contiguous block holding the CPU-side texels of every texture.
+// At load time each image is normalized to RGBA8 and resized to the same
+// power-of-two size class, so any texture can be sampled with the same
+// mask and the same texel offset. Textures are addressed by their byte
+// offset inside the arena (Texture2D::ArenaOffset).
+class TexelArena
+{
+public:
+    // Side of every texture stored in the arena (power of two)
+    unsigned int Size = 0;
+    // Size - 1, used to wrap texel coordinates
+    unsigned int Mask = 0;
+    // Memory order of the texels inside each texture
+    TexelLayout Layout = TEXEL_ROW_MAJOR;
+
+    TexelArena() { }
+    ~TexelArena();
+
+    // The arena owns its storage, so it cannot be copied
+    TexelArena(const TexelArena&) = delete;
+    TexelArena& operator=(const TexelArena&) = delete;
+
+    // Reserves room for count textures, all normalized to size x size
+    void Allocate(unsigned int count, unsigned int size, TexelLayout layout);
+    // Converts an image (1 to 4 channels, any size) into row-major RGBA8 with the size of the arena
+    std::vector<unsigned char> Normalize(const unsigned char* data, unsigned int width, unsigned int height, unsigned int channels) const;
+    // Copies a normalized image into the next free slot (in the arena layout) and returns its slot index
+    unsigned int Store(const std::vector<unsigned char>& rgba);
+    // Takes the next free slot without filling it (for textures built at runtime)
+    unsigned int Reserve();
+    // Overwrites a slot with a normalized image
+    void Write(unsigned int slot, const std::vector<unsigned char>& rgba);
+    // Frees the storage
+    void Clear();
+
+    // Keeps a palette index for every texel, from now on also for the slots written later
+    void Quantize(const Palette& palette);
+    // Palette index of the texel at a byte offset of the arena (Quantize must have been called)
+    unsigned char Index(size_t offset) const { return this->indices[offset / TEXEL_ARENA_CHANNELS]; }
+    // Texels of the slots in use
+    size_t UsedTexels() const { return static_cast<size_t>(this->count) * this->Size * this->Size; }
+
+    // Start of the storage (64-byte aligned)
+    const unsigned char* Data() const { return this->data; }
+    // Bytes used by each texture
+    size_t TextureBytes() const { return static_cast<size_t>(this->Size) * this->Size * TEXEL_ARENA_CHANNELS; }
+    // Byte offset of the first texel of a slot
+    size_t SlotOffset(unsigned int slot) const { return slot * this->TextureBytes(); }
+    // Byte offset of the texel (x, y) relative to the start of its texture
+    unsigned int TexelOffset(unsigned int x, unsigned int y) const { return TexelIndex(this->Layout, x, y, this->Size, this->Size) * TEXEL_ARENA_CHANNELS; }
+
+    // Rounds a dimension up to the next power of two
+    static unsigned int SizeClass(unsigned int dimension);
+
+private:
+    unsigned char* data = nullptr;
+    unsigned int capacity = 0; // Number of texture slots
+    unsigned int count = 0;    // Number of slots in use
+
+    // Indexed copy of the texels (one byte per texel) and the palette they index
+    std::vector<unsigned char> indices;
+    const Palette* palette = nullptr;
+
+    // Quantizes the texels of a slot into its indices
+    void quantizeSlot(unsigned int slot);
+};
+
+#endif
@@ -0,0 +1,51 @@
+#include "texelLayout.h"
+
+#include <cstring>
+
+
+// Checks if a value is a power of two
+static bool isPowerOfTwo(unsigned int value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+bool TexelLayoutSupported(TexelLayout layout, unsigned int width, unsigned int height)
+{
+    switch(layout) {
+        case TEXEL_TILED:
+            // Needs whole tiles in both directions
+            return isPowerOfTwo(width) && isPowerOfTwo(height) &&
+                   width >= TEXEL_TILE_SIZE && height >= TEXEL_TILE_SIZE;
+        case TEXEL_MORTON:
+            return isPowerOfTwo(width) && isPowerOfTwo(height);
+        default:
+            return true;
+    }
+}
+
+std::vector<unsigned char> SwizzleTexels(const unsigned char* data, unsigned int width, unsigned int height,
+                                         unsigned int channels, TexelLayout layout)
+{
+    std::vector<unsigned char> swizzled(width * height * channels);
+
+    // Copy each texel from its row-major spot into the new one
+    for(unsigned int y = 0; y < height; y++) {
+        for(unsigned int x = 0; x < width; x++) {
+            unsigned int from = (y * width + x) * channels;
+            unsigned int to = TexelIndex(layout, x, y, width, height) * channels;
+            std::memcpy(&swizzled[to], &data[from], channels);
+        }
+    }
+
+    return swizzled;
+}
+
+bool ParseTexelLayout(const char* name, TexelLayout& layout)
+{
+    if(std::strcmp(name, "linear") == 0)      layout = TEXEL_ROW_MAJOR;
+    else if(std::strcmp(name, "tiled") == 0)  layout = TEXEL_TILED;
+    else if(std::strcmp(name, "morton") == 0) layout = TEXEL_MORTON;
+    else return false;
+
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef TEXEL_LAYOUT_H
+#define TEXEL_LAYOUT_H
+
+#include <vector>
+
+// Memory order of the texels kept on the CPU side for the floor casting.
+// The floor rays cross the textures diagonally, so a row-major buffer makes
+// almost every fetch land on a different cache line. The swizzled layouts
+// keep texels that are close in 2D also close in memory.
+enum TexelLayout {
+    TEXEL_ROW_MAJOR, // Classic scanline order
+    TEXEL_TILED,     // 4x4 texel tiles stored one after the other
+    TEXEL_MORTON     // Z-order curve (bits of x and y interleaved)
+};
+
+// Side of the square tiles used by TEXEL_TILED
+const unsigned int TEXEL_TILE_SIZE = 4;
+
+// Checks if the layout can be applied to a texture with these dimensions.
+// The swizzled layouts need power-of-two sizes, which is already required by
+// the bitmasks of the floor casting
+bool TexelLayoutSupported(TexelLayout layout, unsigned int width, unsigned int height);
+
+// Converts a texel coordinate into its position (in texels, not bytes) inside the buffer.
+// x and y must already be inside the texture (e.g. masked with Width-1 and Height-1)
+inline unsigned int TexelIndex(TexelLayout layout, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+// Reorders a row-major texel buffer into the requested layout
+std::vector<unsigned char> SwizzleTexels(const unsigned char* data, unsigned int width, unsigned int height,
+                                         unsigned int channels, TexelLayout layout);
+
+// Parses the layout name used in the command line (linear, tiled or morton)
+bool ParseTexelLayout(const char* name, TexelLayout& layout);
+
+
+// ===================== INLINE IMPLEMENTATION =====================
+// Kept in the header because it runs once per floor/ceiling pixel
+
+// Spreads the lower 16 bits of v so there is a zero between each of them
+inline unsigned int MortonSpread(unsigned int v)
+{
+    v &= 0x0000FFFF;
+    v = (v | (v << 8)) & 0x00FF00FF;
+    v = (v | (v << 4)) & 0x0F0F0F0F;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+inline unsigned int TexelIndex(TexelLayout layout, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+    switch(layout) {
+
+        case TEXEL_TILED: {
+            // Tile that holds the texel + position of the texel inside the tile
+            unsigned int tile = (y / TEXEL_TILE_SIZE) * (width / TEXEL_TILE_SIZE) + (x / TEXEL_TILE_SIZE);
+            return tile * TEXEL_TILE_SIZE * TEXEL_TILE_SIZE + (y % TEXEL_TILE_SIZE) * TEXEL_TILE_SIZE + (x % TEXEL_TILE_SIZE);
+        }
+
+        case TEXEL_MORTON: {
+            // Square textures are a plain Z-order curve. On rectangular ones the
+            // extra bits of the longest axis are stacked on top of the curve
+            if(width == height)
+                return MortonSpread(x) | (MortonSpread(y) << 1);
+
+            unsigned int side = width < height ? width : height;
+            unsigned int square = side * side;
+            if(width >= height)
+                return (x / side) * square + (MortonSpread(x & (side - 1)) | (MortonSpread(y) << 1));
+            else
+                return (y / side) * square + (MortonSpread(x) | (MortonSpread(y & (side - 1)) << 1));
+        }
+
+        default:
+            return y * width + x;
+    }
+}
+
+#endif
@@ -1,41 +1,28 @@
-
 #include "textRenderer.h"
+#include "glState.h"
 
 // GLM Mathematics Library headers
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 
 
 TextRenderer::TextRenderer(Shader &shader)
+    : shader(shader), atlas(GL_RED, GL_RED, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_LINEAR, GL_LINEAR)
 {
-    this->shader = shader;
-    this->initRenderData();
+    this->colorLocation = shader.Location("textColor");
+    this->transformLocation = shader.Location("textTransform");
 }
 
 TextRenderer::~TextRenderer()
 {
-    //glDeleteVertexArrays(1, &this->quadVAO);
-}
-
-void TextRenderer::initRenderData()
-{
-
-    // configure VAO/VBO
-    glGenVertexArrays(1, &this->quadVAO);
-    glGenBuffers(1, &this->quadVBO);
-    glBindVertexArray(this->quadVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-
+    // The atlas and the meshes are deleted with their owners
 }
 
 void TextRenderer::LoadFont(std::string path, int size) {
@@ -67,11 +54,13 @@ void TextRenderer::LoadFont(std::string path, int size) {
         // set size to load glyphs as
         FT_Set_Pixel_Sizes(face, 0, size);
 
-        // disable byte-alignment restriction
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        // The glyphs are placed in rows (shelves) of the atlas, one pixel apart so the filtering does not mix them
+        std::vector<std::vector<unsigned char>> bitmaps(TEXT_GLYPHS);
+        std::vector<glm::ivec2> places(TEXT_GLYPHS);
+        int penX = 1, penY = 1, rowHeight = 0;
 
         // load first 128 characters of ASCII set
-        for (unsigned char c = 0; c < 128; c++)
+        for (unsigned char c = 0; c < TEXT_GLYPHS; c++)
         {
             // Load character glyph 
             if (FT_Load_Char(face, c, FT_LOAD_RENDER))
@@ -79,17 +68,46 @@ void TextRenderer::LoadFont(std::string path, int size) {
                 std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
                 continue;
             }
-            // generate texture
-            Texture2D tex(GL_RED, GL_RED, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_LINEAR, GL_LINEAR); 
-            tex.Generate(face->glyph->bitmap.width,face->glyph->bitmap.rows, face->glyph->bitmap.buffer);
-
-            // Create instance of character
-            Character character(tex.ID, glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-                                glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top), static_cast<unsigned int>(face->glyph->advance.x));
-            
-            // Save character texture in the resourse manager
-            ResourceManager::LoadCharacter(c, character);
+            const FT_Bitmap& bitmap = face->glyph->bitmap;
+            int width = bitmap.width, rows = bitmap.rows;
+
+            // Copy the glyph rows (the bitmap rows can be padded)
+            bitmaps[c].resize(width * rows);
+            for(int row = 0; row < rows; row++)
+                std::memcpy(&bitmaps[c][row * width], bitmap.buffer + row * bitmap.pitch, width);
+
+            if(penX + width + 1 > static_cast<int>(TEXT_ATLAS_WIDTH)) {
+                penX = 1;
+                penY += rowHeight + 1;
+                rowHeight = 0;
+            }
+            places[c] = glm::ivec2(penX, penY);
+            penX += width + 1;
+            rowHeight = std::max(rowHeight, rows);
+
+            this->glyphs[c] = Character(glm::vec4(0.0f), glm::ivec2(width, rows),
+                                        glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top), static_cast<unsigned int>(face->glyph->advance.x));
         }
+
+        // Compose the atlas and upload it at once
+        unsigned int atlasHeight = 1;
+        while(atlasHeight < static_cast<unsigned int>(penY + rowHeight + 1)) atlasHeight <<= 1;
+        std::vector<unsigned char> pixels(TEXT_ATLAS_WIDTH * atlasHeight, 0);
+        for(unsigned int c = 0; c < TEXT_GLYPHS; c++) {
+            Character& glyph = this->glyphs[c];
+            for(int row = 0; row < glyph.Size.y; row++)
+                std::memcpy(&pixels[(places[c].y + row) * TEXT_ATLAS_WIDTH + places[c].x], &bitmaps[c][row * glyph.Size.x], glyph.Size.x);
+
+            glyph.UV = glm::vec4(places[c].x / static_cast<float>(TEXT_ATLAS_WIDTH), places[c].y / static_cast<float>(atlasHeight),
+                                 (places[c].x + glyph.Size.x) / static_cast<float>(TEXT_ATLAS_WIDTH), (places[c].y + glyph.Size.y) / static_cast<float>(atlasHeight));
+        }
+
+        // disable byte-alignment restriction
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        this->atlas.Generate(TEXT_ATLAS_WIDTH, atlasHeight, pixels.data());
+
+        // The cached meshes point into the previous atlas
+        this->meshes.clear();
     }
     // destroy FreeType once we're finished
     FT_Done_Face(face);
@@ -97,48 +115,128 @@ void TextRenderer::LoadFont(std::string path, int size) {
 
 }
 
+void TextRenderer::buildVertices(const std::string &text, std::vector<float> &vertices) const
+{
+    float x = 0.0f;
+    for(unsigned char c : text) {
+        // Characters outside the font are skipped
+        if(c >= TEXT_GLYPHS) continue;
+        const Character& ch = this->glyphs[c];
+
+        float xpos = x + ch.Bearing.x;
+        float ypos = -(ch.Size.y - ch.Bearing.y);
+        float w = ch.Size.x;
+        float h = ch.Size.y;
+
+        if(w > 0.0f && h > 0.0f) {
+            float quad[6][4] = {
+                { xpos,     ypos + h,   ch.UV.x, ch.UV.y },            
+                { xpos,     ypos,       ch.UV.x, ch.UV.w },
+                { xpos + w, ypos,       ch.UV.z, ch.UV.w },
+
+                { xpos,     ypos + h,   ch.UV.x, ch.UV.y },
+                { xpos + w, ypos,       ch.UV.z, ch.UV.w },
+                { xpos + w, ypos + h,   ch.UV.z, ch.UV.y }           
+            };
+            vertices.insert(vertices.end(), &quad[0][0], &quad[0][0] + 6 * 4);
+        }
+        // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
+        x += (ch.Advance >> 6); // bitshift by 6 to get value in pixels (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
+    }
+}
 
-void TextRenderer::DrawText(std::string text, float x, float y, float scale, glm::vec3 color)
+TextMesh& TextRenderer::mesh(const std::string &text)
 {
-    // Activate the corresponding render state
-    this->shader.Use().SetVec3("textColor", color);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(this->quadVAO);
+    auto it = this->meshes.find(text);
+    if(it != this->meshes.end())
+        return it->second;
+
+    // Make room by dropping the string that was drawn the longest time ago
+    if(this->meshes.size() >= TEXT_MESH_CACHE_SIZE) {
+        auto oldest = std::min_element(this->meshes.begin(), this->meshes.end(),
+            [](const auto& a, const auto& b) { return a.second.LastUse < b.second.LastUse; });
+        this->meshes.erase(oldest);
+    }
 
+    // Quads of every glyph, at the origin with scale 1
+    std::vector<float> vertices;
+    vertices.reserve(text.size() * 6 * 4);
+    this->buildVertices(text, vertices);
 
-    // iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++) 
-    {
-        Character ch = ResourceManager::GetCharacter(static_cast<unsigned char>(*c));
-
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
-
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-        // update VBO for each character
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 0.0f },            
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 0.0f }           
-        };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-        x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
+    TextMesh& mesh = this->meshes[text];
+    mesh.Vertices = vertices.size() / 4;
+
+    GLState::BindVertexArray(mesh.VAO.Get());
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO.Get());
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    mesh.VBO.SetBytes(vertices.size() * sizeof(float));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return mesh;
+}
+
+
+void TextRenderer::DrawText(const std::string &text, float x, float y, float scale, glm::vec3 color)
+{
+    TextMesh& mesh = this->mesh(text);
+    mesh.LastUse = ++this->drawCount;
+    if(mesh.Vertices == 0) return;
+
+    this->prepare(x, y, scale, color);
+
+    // The whole string in one draw
+    GLState::BindVertexArray(mesh.VAO.ID());
+    GLState::DrawArrays(GL_TRIANGLES, 0, mesh.Vertices);
+}
+
+void TextRenderer::DrawDynamicText(const std::string &text, float x, float y, float scale, glm::vec3 color)
+{
+    this->streamVertices.clear();
+    this->buildVertices(text, this->streamVertices);
+    if(this->streamVertices.empty()) return;
+
+    // The vertex layout is set once, when the buffer is first used
+    if(this->streamCapacity == 0) {
+        GLState::BindVertexArray(this->streamVAO.Get());
+        glBindBuffer(GL_ARRAY_BUFFER, this->streamVBO.Get());
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    }
+    else
+        glBindBuffer(GL_ARRAY_BUFFER, this->streamVBO.ID());
+
+    // Each string is written after the previous one, the storage is only orphaned when it is full
+    // (like the SpriteBatch), so the draws still reading the buffer are never waited for
+    size_t count = this->streamVertices.size();
+    if(count > this->streamCapacity) {
+        this->streamCapacity = std::max(count * 2, TEXT_STREAM_MIN_FLOATS);
+        this->streamCursor = this->streamCapacity; // Forces the allocation below
     }
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-} 
+    if(this->streamCursor + count > this->streamCapacity) {
+        glBufferData(GL_ARRAY_BUFFER, this->streamCapacity * sizeof(float), nullptr, GL_STREAM_DRAW);
+        this->streamVBO.SetBytes(this->streamCapacity * sizeof(float));
+        this->streamCursor = 0;
+    }
+    void* range = glMapBufferRange(GL_ARRAY_BUFFER, this->streamCursor * sizeof(float), count * sizeof(float),
+                                   GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    std::memcpy(range, this->streamVertices.data(), count * sizeof(float));
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    this->prepare(x, y, scale, color);
+
+    GLState::BindVertexArray(this->streamVAO.ID());
+    GLState::DrawArrays(GL_TRIANGLES, this->streamCursor / 4, count / 4);
+    this->streamCursor += count;
+}
+
+void TextRenderer::prepare(float x, float y, float scale, glm::vec3 color)
+{
+    // Activate the corresponding render state
+    this->shader.Use().SetVec3(this->colorLocation, color);
+    this->shader.SetVec3(this->transformLocation, glm::vec3(x, y, scale));
+    GLState::ActiveTexture(GL_TEXTURE0);
+    this->atlas.Bind();
+}
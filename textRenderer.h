@@ -1,4 +1,3 @@
-
 #ifndef TEXTRENDERER_H
 #define TEXTRENDERER_H
 
@@ -9,14 +8,41 @@
 #include "texture.h"
 #include "shader.h"
 #include "character.h"
+#include "glObject.h"
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 
 namespace fs = std::filesystem;
 
+// Glyphs loaded from the font (the ASCII set)
+const unsigned int TEXT_GLYPHS = 128;
+// Width of the font atlas in pixels (the height grows with the glyphs)
+const unsigned int TEXT_ATLAS_WIDTH = 512;
+// Strings kept as meshes, the least recently drawn one is dropped to make room
+const unsigned int TEXT_MESH_CACHE_SIZE = 64;
+// Smallest streaming buffer of the uncached strings, in floats (a few frames of counters)
+const size_t TEXT_STREAM_MIN_FLOATS = 16384;
+
+// Quads of a whole string, ready to be drawn with one draw call
+struct TextMesh
+{
+    GLVertexArray VAO;
+    GLBuffer      VBO;
+    GLsizei       Vertices = 0;
+    unsigned long LastUse = 0; // Draw counter of the last time it was drawn
+};
+
+// Draws strings with a font packed in a single atlas texture. Each string
+// is turned into a mesh at the origin the first time it is drawn and kept
+// by its content, so the strings that do not change (menus, labels) cost
+// one draw call per frame and nothing else. The position and the scale are
+// applied by the vertex shader.
 class TextRenderer
 {
     public:
@@ -25,17 +51,44 @@ class TextRenderer
         ~TextRenderer();
 
             
-    void DrawText(std::string text,
+    void DrawText(const std::string &text,
+    float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+
+    // Same as DrawText for strings that change every frame (counters): the quads go through
+    // a streaming buffer and the string is never cached, so it does not push the others out
+    void DrawDynamicText(const std::string &text,
     float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
 
     void LoadFont(std::string path, int size);
 
+    // Strings currently cached as meshes
+    size_t CachedMeshes() const { return this->meshes.size(); }
+
     private:
-        Shader       shader; 
-        unsigned int quadVAO;
-        unsigned int quadVBO;
+        Shader       &shader; // Stored in the ResourceManager
+        GLint        colorLocation;     // Handle of the textColor uniform
+        GLint        transformLocation; // Handle of the textTransform uniform
+
+        // Font atlas (one red channel) and the place of each glyph in it
+        Texture2D    atlas;
+        Character    glyphs[TEXT_GLYPHS];
+
+        std::unordered_map<std::string, TextMesh> meshes;
+        unsigned long drawCount = 0;
+
+        // Streaming buffer of the uncached strings
+        GLVertexArray streamVAO;
+        GLBuffer      streamVBO;
+        size_t        streamCapacity = 0; // Floats the buffer can hold
+        size_t        streamCursor = 0;   // First free float, the next string is written there
+        std::vector<float> streamVertices;
 
-        void initRenderData();
+        // Appends the quads of a string (at the origin with scale 1) to vertices
+        void buildVertices(const std::string &text, std::vector<float> &vertices) const;
+        // Returns the mesh of a string, building it when it is not cached
+        TextMesh &mesh(const std::string &text);
+        // Sets the shader and the atlas up to draw a string
+        void prepare(float x, float y, float scale, glm::vec3 color);
 };
 
-#endif
\ No newline at end of file
+#endif
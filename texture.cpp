@@ -1,12 +1,13 @@
 #include <iostream>
 
 #include "texture.h"
+#include "glState.h"
 
 // Default Constructor
 Texture2D::Texture2D()
     : Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR)
 {
-    glGenTextures(1, &this->ID);
+
 }
 
 // Constructor with arguments
@@ -15,7 +16,7 @@ Texture2D::Texture2D(unsigned int internal_format, unsigned int image_format, un
     Width(0), Height(0), Internal_Format(internal_format), Image_Format(image_format), Wrap_S(wrap_s), Wrap_T(wrap_t),
     Filter_Min(filter_min), Filter_Max(filter_max) 
     {
-        glGenTextures(1,  &this->ID);
+
     }
 
 void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char* data)
@@ -24,29 +25,32 @@ void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char*
     this->Height = height;
     this->IsInitialized = true; // glTexImage2D is called
 
-    // create Texture
-    glBindTexture(GL_TEXTURE_2D, this->ID);
+    // create Texture (the GL name is created here the first time)
+    GLState::BindTexture(GL_TEXTURE_2D, this->Object.Get());
     glTexImage2D(GL_TEXTURE_2D, 0, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
+    this->Object.SetBytes(GLObjects::TextureBytes(this->Internal_Format, width, height));
     // set Texture wrap and filter modes
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, this->Wrap_S);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, this->Wrap_T);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->Filter_Min);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->Filter_Max);
-    // unbind texture
-    glBindTexture(GL_TEXTURE_2D, 0);
     
 }
 
 void Texture2D::Bind() const
 {
-    glBindTexture(GL_TEXTURE_2D, this->ID);
+    GLState::BindTexture(GL_TEXTURE_2D, this->ID());
 }
 
 void Texture2D::Update(unsigned char* data) {
 
-    glBindTexture(GL_TEXTURE_2D, this->ID);
+    GLState::BindTexture(GL_TEXTURE_2D, this->ID());
     // GL method that updates texture
     // glTexImage2D must be called previously
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, this->Width, this->Height, this->Image_Format, GL_UNSIGNED_BYTE, data);
-    glBindTexture(GL_TEXTURE_2D, 0);
-}
\ No newline at end of file
+}
+
+void TextureHandle::Bind() const
+{
+    GLState::BindTexture(GL_TEXTURE_2D, this->ID);
+}
@@ -3,15 +3,21 @@
 #define TEXTURE_H
 
 #include "glad/glad.h"
-#include <vector>
+#include "glObject.h"
+#include <cstddef>
+#include <cstdint>
 
 // Texture2D is able to store and configure a texture in OpenGL.
 // It also hosts utility functions for easy management.
+// It owns its GL texture, which is only created by Generate, so it can be
+// moved but not copied (TextureHandle is the copyable reference).
 class Texture2D
 {
 public:
-    // holds the ID of the texture object, used for all texture operations to reference to this particular texture
-    unsigned int ID;
+    // owns the texture object, used for all texture operations to reference to this particular texture
+    GLTexture Object;
+    // GL name of the texture (0 until Generate is called)
+    unsigned int ID() const { return this->Object.ID(); }
     // texture image dimensions
     unsigned int Width, Height; // width and height of loaded image in pixels
     // texture Format
@@ -24,7 +30,8 @@ public:
     unsigned int Filter_Max; // filtering mode if texture pixels > screen pixels
     
     //====== ONLY USED FOR FLOOR CASTING =======
-    std::vector<unsigned char> PixelBuffer; // Buffer to save image content on CPU-SIDE only when is nedded
+    size_t ArenaOffset = SIZE_MAX; // Byte offset of the CPU-side texels inside ResourceManager::Arena (RGBA8), SIZE_MAX until loaded
+    unsigned int Layer = 0; // Slot of the texture in the arena and layer in ResourceManager::TextureLayers
     bool IsInitialized = false; // Flag to check if the glTexImage2D was called once so it is possible to Update the buffer
     // Update the texture inside the class
     void Update(unsigned char* data);
@@ -42,5 +49,29 @@ public:
     void Bind() const;
 };
 
+// Reference to a Texture2D that lives somewhere else (the ResourceManager
+// for the level textures). It is what the game objects and the level cells
+// hold: copying it copies the GL name and a pointer, never the texture.
+// The metadata (size, arena offset, layer) is read through ->.
+class TextureHandle
+{
+public:
+    // GL name of the texture (0 when the handle is empty)
+    unsigned int ID = 0;
+
+    TextureHandle() { }
+    explicit TextureHandle(const Texture2D& texture) : ID(texture.ID()), texture(&texture) { }
+
+    // metadata of the referenced texture
+    const Texture2D* operator->() const { return this->texture; }
+    // false for an empty handle
+    bool Valid() const { return this->texture != nullptr; }
+    // binds the texture as the current active GL_TEXTURE_2D texture object
+    void Bind() const;
+
+private:
+    const Texture2D* texture = nullptr;
+};
+
 #endif
 
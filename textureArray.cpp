@@ -0,0 +1,44 @@
+#include "textureArray.h"
+#include "glState.h"
+
+
+// Default Constructor
+TextureArray::TextureArray()
+    : Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR)
+{
+
+}
+
+void TextureArray::Generate(unsigned int width, unsigned int height, unsigned int layers)
+{
+    this->Width = width;
+    this->Height = height;
+    this->Layers = layers;
+
+    // create Texture storage for every layer (the texture name is only created when there is something to store)
+    GLState::BindTexture(GL_TEXTURE_2D_ARRAY, this->Object.Get());
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    this->Object.SetBytes(GLObjects::TextureBytes(GL_RGBA8, width, height, layers));
+    // set Texture wrap and filter modes
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, this->Wrap_S);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, this->Wrap_T);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, this->Filter_Min);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, this->Filter_Max);
+}
+
+void TextureArray::SetLayer(unsigned int layer, const unsigned char* data)
+{
+    GLState::BindTexture(GL_TEXTURE_2D_ARRAY, this->Object.ID());
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, this->Width, this->Height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+}
+
+void TextureArray::Bind() const
+{
+    GLState::BindTexture(GL_TEXTURE_2D_ARRAY, this->Object.ID());
+}
+
+void TextureArray::Release()
+{
+    this->Object.Reset();
+    this->Width = this->Height = this->Layers = 0;
+}
@@ -0,0 +1,36 @@
+#ifndef TEXTURE_ARRAY_H
+#define TEXTURE_ARRAY_H
+
+#include "glad/glad.h"
+#include "glObject.h"
+
+// TextureArray stores several textures with the same size as layers of a
+// single GL_TEXTURE_2D_ARRAY, so shaders can pick the texture per instance
+// and a whole batch of sprites can be drawn with one texture bind.
+class TextureArray
+{
+public:
+    // owns the texture object
+    GLTexture Object;
+    // size of each layer in pixels and number of layers
+    unsigned int Width = 0, Height = 0, Layers = 0;
+    // texture configuration
+    unsigned int Wrap_S; // wrapping mode on S axis
+    unsigned int Wrap_T; // wrapping mode on T axis
+    unsigned int Filter_Min; // filtering mode if texture pixels < screen pixels
+    unsigned int Filter_Max; // filtering mode if texture pixels > screen pixels
+
+    // constructor (sets default texture modes)
+    TextureArray();
+
+    // allocates the storage for all the layers (RGBA8)
+    void Generate(unsigned int width, unsigned int height, unsigned int layers);
+    // uploads the RGBA texels of one layer
+    void SetLayer(unsigned int layer, const unsigned char* data);
+    // binds the texture as the current active GL_TEXTURE_2D_ARRAY texture object
+    void Bind() const;
+    // deletes the texture (Generate creates it again)
+    void Release();
+};
+
+#endif
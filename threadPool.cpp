@@ -0,0 +1,84 @@
+#include "threadPool.h"
+
+#include <algorithm>
+
+
+ThreadPool::ThreadPool(unsigned int threads)
+{
+    if(threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // The calling thread also works, so it counts as one of them
+    for(unsigned int i = 1; i < threads; i++)
+        this->workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->closing = true;
+    }
+    this->wake.notify_all();
+
+    for(std::thread& worker : this->workers)
+        worker.join();
+}
+
+void ThreadPool::ParallelFor(unsigned int count, const std::function<void(unsigned int)>& job)
+{
+    if(count == 0) return;
+
+    // Nothing to share
+    if(this->workers.empty() || count == 1) {
+        for(unsigned int i = 0; i < count; i++) job(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->job = &job;
+        this->jobCount = count;
+        this->nextPiece = 0;
+        this->busy = this->workers.size();
+        this->generation++;
+    }
+    this->wake.notify_all();
+
+    // Works too instead of only waiting
+    this->runPieces();
+
+    // The job lives on the caller's stack, so every worker must be out of it before returning
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->finished.wait(lock, [this] { return this->busy == 0; });
+    this->job = nullptr;
+}
+
+void ThreadPool::runPieces()
+{
+    unsigned int piece;
+    while((piece = this->nextPiece.fetch_add(1)) < this->jobCount)
+        (*this->job)(piece);
+}
+
+void ThreadPool::workerLoop()
+{
+    unsigned int seen = 0;
+
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->wake.wait(lock, [this, seen] { return this->closing || this->generation != seen; });
+            if(this->closing) return;
+            seen = this->generation;
+        }
+
+        this->runPieces();
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->busy--;
+        }
+        this->finished.notify_one();
+    }
+}
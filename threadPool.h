@@ -0,0 +1,50 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small pool of worker threads that stay alive for the whole game.
+// ParallelFor splits a job in numbered pieces; the workers (and the calling
+// thread) grab the next free piece until all of them are done, so pieces
+// with very different costs still balance out.
+class ThreadPool
+{
+public:
+    // threads = 0 uses one thread per hardware core
+    ThreadPool(unsigned int threads = 0);
+    ~ThreadPool();
+
+    // The workers keep a pointer to the pool, so it cannot be copied
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Runs job(0) ... job(count - 1) in parallel and returns when all of them finished
+    void ParallelFor(unsigned int count, const std::function<void(unsigned int)>& job);
+
+    // Number of threads working on a job (workers + the caller)
+    unsigned int Size() const { return this->workers.size() + 1; }
+
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake;     // A new job is available (or the pool is closing)
+    std::condition_variable finished; // All the workers left the current job
+
+    const std::function<void(unsigned int)>* job = nullptr;
+    unsigned int jobCount = 0;
+    std::atomic<unsigned int> nextPiece{0};
+    unsigned int generation = 0; // Incremented for every job, wakes the workers
+    unsigned int busy = 0;       // Workers still inside the current job
+    bool closing = false;
+
+    void workerLoop();
+    void runPieces();
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "viewTarget.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+
+ViewTarget::ViewTarget(SpriteRenderer &renderer, Shader &upscaleShader, FrameUniforms &frame, glm::vec2 position, glm::vec2 size,
+                       float scale, UpscaleFilter filter)
+    : Position(position), Size(size), Native(0), Internal(0), Scale(1.0f), Filter(filter),
+      renderer(renderer), shader(upscaleShader), frame(frame),
+      image(GL_RGBA, GL_RGBA, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_LINEAR, GL_LINEAR)
+{
+    this->Scale = std::clamp(scale, VIEW_MIN_SCALE, 1.0f);
+}
+
+void ViewTarget::Resize(int framebufferWidth, int framebufferHeight)
+{
+    // The view keeps its share of the screen in the framebuffer pixels
+    glm::vec2 pixels = this->Size * glm::vec2(framebufferWidth, framebufferHeight) / this->frame.Data.ScreenSize;
+    glm::ivec2 native = glm::max(glm::ivec2(glm::round(pixels)), glm::ivec2(1));
+
+    // Allocated at the native size even at scale 1, so the first change of scale does not stall
+    if(native != this->Native) {
+        this->Native = native;
+        this->image.Generate(native.x, native.y, nullptr);
+
+        GLint previousFramebuffer;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, this->framebuffer.Get());
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->image.ID(), 0);
+        if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "ERROR::VIEW_TARGET: the offscreen framebuffer is not complete" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    }
+
+    this->update();
+}
+
+void ViewTarget::SetScale(float scale)
+{
+    this->Scale = std::clamp(scale, VIEW_MIN_SCALE, 1.0f);
+    this->update();
+}
+
+void ViewTarget::SetFilter(UpscaleFilter filter)
+{
+    this->Filter = filter;
+    this->update();
+}
+
+void ViewTarget::update()
+{
+    glm::vec2 pixels = glm::vec2(this->Native) * this->Scale;
+    this->Internal = glm::clamp(glm::ivec2(glm::round(pixels)), glm::ivec2(1), this->Native);
+    if(!this->Active()) return;
+
+    // Sharp bilinear keeps whole window pixels per view pixel inside each texel
+    float prescale = 0.0f;
+    if(this->Filter == UPSCALE_SHARP_BILINEAR) {
+        glm::vec2 ratio = glm::vec2(this->Native) / glm::vec2(this->Internal);
+        prescale = std::max(std::floor(std::min(ratio.x, ratio.y)), 1.0f);
+    }
+    this->shader.SetFloat("prescale", prescale, true);
+    this->shader.SetVec2("sourceSize", glm::vec2(this->Internal), true);
+}
+
+void ViewTarget::Begin()
+{
+    if(!this->Active()) return;
+
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &this->previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, this->previousViewport);
+    this->screenProjection = this->frame.Data.Projection;
+    this->screenViewStart = this->frame.Data.ViewStart;
+    this->screenViewWidth = this->frame.Data.ViewWidth;
+
+    // Only the corner of the texture at the current scale is drawn
+    glBindFramebuffer(GL_FRAMEBUFFER, this->framebuffer.ID());
+    glViewport(0, 0, this->Internal.x, this->Internal.y);
+    // With the clear color of the screen, which shows wherever the view draws nothing
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // Same orientation as the screen projection (so the culled faces are the same): the top of the view
+    // ends up in the last drawn row. The whole target is the view
+    this->frame.SetProjection(glm::ortho(this->Position.x, this->Position.x + this->Size.x,
+                                         this->Position.y + this->Size.y, this->Position.y, -1.0f, 1.0f));
+    this->frame.SetView(0.0f, static_cast<float>(this->Internal.x));
+}
+
+void ViewTarget::End()
+{
+    if(!this->Active()) return;
+
+    this->frame.SetProjection(this->screenProjection);
+    this->frame.SetView(this->screenViewStart, this->screenViewWidth);
+    glBindFramebuffer(GL_FRAMEBUFFER, this->previousFramebuffer);
+    glViewport(this->previousViewport[0], this->previousViewport[1], this->previousViewport[2], this->previousViewport[3]);
+
+    // The drawn corner stretched over the view (v goes up from the bottom row)
+    glm::vec4 uv(0.0f, this->Internal.y / static_cast<float>(this->image.Height), this->Internal.x / static_cast<float>(this->image.Width), 0.0f);
+    this->renderer.DrawSprite(TextureHandle(this->image), this->Position, this->Size, 0.0f, glm::vec3(1.0f), glm::vec2(0.5f), uv);
+}
@@ -0,0 +1,77 @@
+#ifndef VIEW_TARGET_H
+#define VIEW_TARGET_H
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "frameUniforms.h"
+#include "glObject.h"
+#include "shader.h"
+#include "spriteRenderer.h"
+#include "texture.h"
+
+// Lowest internal resolution of the 3D view, as a fraction of the native one
+const float VIEW_MIN_SCALE = 0.25f;
+// Change of the scale on each press of the resolution keys
+const float VIEW_SCALE_STEP = 0.125f;
+
+// How the internal resolution is stretched to the window
+enum UpscaleFilter {
+    UPSCALE_NEAREST,        // Square pixels, blocky at non-integer ratios
+    UPSCALE_SHARP_BILINEAR  // Square pixels with their edges blended over one window pixel
+};
+
+// Offscreen target of the 3D view for dynamic resolution. Below the
+// native resolution the view is drawn into a smaller framebuffer and then
+// stretched over its place on the screen with one quad, so the fragment
+// work of the floor, walls, sky and sprites drops with the square of the
+// scale. The texture is allocated at the native size of the view and only
+// the corner of Internal pixels is drawn, so the scale can change on any
+// frame without reallocating anything; only a new window size does.
+// At scale 1 the view is drawn straight to the screen as before.
+class ViewTarget
+{
+public:
+    // Place of the view on the game screen (screen units)
+    glm::vec2 Position, Size;
+    // Pixels of the view on the window framebuffer, and the pixels drawn at the current scale
+    glm::ivec2 Native, Internal;
+    // Internal / native, from VIEW_MIN_SCALE to 1
+    float Scale;
+    UpscaleFilter Filter;
+
+    // The stretched quad is drawn with renderer (upscale shader); frame holds the projection swapped while drawing
+    ViewTarget(SpriteRenderer &renderer, Shader &upscaleShader, FrameUniforms &frame, glm::vec2 position, glm::vec2 size,
+               float scale = 1.0f, UpscaleFilter filter = UPSCALE_SHARP_BILINEAR);
+
+    // The window framebuffer changed size (reallocates the texture when the native size changes)
+    void Resize(int framebufferWidth, int framebufferHeight);
+    // Changes the internal resolution (clamped to [VIEW_MIN_SCALE, 1])
+    void SetScale(float scale);
+    void SetFilter(UpscaleFilter filter);
+    // False at scale 1, when the view goes straight to the screen
+    bool Active() const { return this->Internal != this->Native; }
+
+    // Everything drawn between Begin and End is part of the view
+    void Begin();
+    void End();
+
+private:
+    SpriteRenderer &renderer;
+    Shader         &shader;
+    FrameUniforms  &frame;
+
+    Texture2D     image;
+    GLFramebuffer framebuffer;
+
+    // What Begin replaced, put back by End
+    GLint     previousFramebuffer = 0;
+    GLint     previousViewport[4] = {0, 0, 0, 0};
+    glm::mat4 screenProjection;
+    float     screenViewStart = 0.0f, screenViewWidth = 0.0f;
+
+    // Internal size from the scale, and the upscale uniforms that depend on it
+    void update();
+};
+
+#endif